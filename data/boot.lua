@@ -59,6 +59,12 @@ love.handlers = setmetatable({
 	homepressed = function(w)
 		if love.homepressed then return love.homepressed(w) end
 	end,
+	loaded = function(i,o,e)
+		if love.loaded then return love.loaded(i,o,e) end
+	end,
+	screenshot = function(f,e)
+		if love.screenshot then return love.screenshot(f,e) end
+	end,
 }, {
 	__index = function(self, name)
 		error("Unknown event: " .. name)
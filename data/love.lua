@@ -24,11 +24,16 @@ License along with this program.  If not, see
 local ipairs = ipairs
 local loadstring = loadstring
 local setmetatable = setmetatable
+local type = type
 
 -- Global usertype workaround
 love.graphics.newFont = _Font.new
+love.graphics.newImageData = _ImageData.new
+love.graphics.newParticleSystem = _ParticleSystem.new
 love.graphics.newQuad = _Quad.new
 love.graphics.newTexture = _Texture.new
+love.graphics.newTileMap = _TileMap.new
+love.graphics.newVideo = _Video.new
 
 -- love.audio
 do
@@ -119,6 +124,12 @@ do
 	local newFont = love.graphics.newFont
 	local setFont = love.graphics.setFont
 
+	local newAtlas = love.graphics.newAtlas
+	local newTexture = love.graphics.newTexture
+	local newImageData = love.graphics.newImageData
+	local newParticleSystem = love.graphics.newParticleSystem
+	local newVideo = love.graphics.newVideo
+
 	function love.graphics.clear(r, g, b, a)
 		a = a or 255
 
@@ -174,6 +185,11 @@ do
 		drawQuad(texture, textureQuad, x, y, r, sx, sy, ox, oy)
 	end
 
+	function love.graphics.newImageFont(filename, glyphs, spacing)
+		spacing = spacing or 0
+
+		return newFont(filename, glyphs, spacing)
+	end
 	function love.graphics.setNewFont(...)
 		local font = newFont(...)
 
@@ -181,6 +197,73 @@ do
 
 		return font
 	end
+
+	function love.graphics.newAtlas(paths, maxSize)
+		maxSize = maxSize or 1024
+
+		return newAtlas(paths, maxSize)
+	end
+	function love.graphics.newTexture(filename, settings)
+		if type(filename) ~= "string" then return newTexture(filename) end -- ImageData
+
+		local format = settings and settings.format or "rgba8"
+		local mipmaps = settings and settings.mipmaps or false
+		local lazy = settings and settings.lazy or false
+
+		return newTexture(filename, format, mipmaps, lazy)
+	end
+	function love.graphics.newImageData(width, height, format)
+		if type(width) ~= "number" then return newImageData(width) end -- Texture
+
+		format = format or "rgba8"
+
+		return newImageData(width, height, format)
+	end
+	function love.graphics.newParticleSystem(texture, maxParticles)
+		maxParticles = maxParticles or 1000
+
+		return newParticleSystem(texture, maxParticles)
+	end
+	function love.graphics.newVideo(filename, fps)
+		fps = fps or 30
+
+		return newVideo(filename, fps)
+	end
+end
+
+do
+	local newFont = love.loader.newFont
+	local newTexture = love.loader.newTexture
+
+	-- Async variants of the loading functions, results arrive through love.loaded(id, object, err)
+	function love.loader.newFont(filename, size)
+		size = size or 12
+
+		return newFont(filename, size)
+	end
+	function love.loader.newTexture(filename, settings)
+		local format = settings and settings.format or "rgba8"
+		local mipmaps = settings and settings.mipmaps or false
+
+		return newTexture(filename, format, mipmaps)
+	end
+end
+
+do
+	local newTransform = _Transform.new
+
+	function love.math.newTransform(x, y, r, sx, sy, ox, oy)
+		if x == nil then return newTransform() end
+
+		y = y or 0
+		r = r or 0
+		sx = sx or 1
+		sy = sy or sx
+		ox = ox or 0
+		oy = oy or 0
+
+		return newTransform(x, y, r, sx, sy, ox, oy)
+	end
 end
 
 do
@@ -199,7 +282,12 @@ end
 -- Delete global usertypes
 _Source = nil
 _Font = nil
+_ImageData = nil
+_ParticleSystem = nil
 _Quad = nil
 _Texture = nil
+_TileMap = nil
+_Video = nil
+_Transform = nil
 
 return love
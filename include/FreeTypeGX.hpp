@@ -137,6 +137,8 @@
 #include <ogc/gx.h>
 #include <map>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 /*! \struct ftgxCharData_
  *
@@ -155,6 +157,17 @@ typedef struct ftgxCharData_ {
 	uint32_t* glyphDataTexture;	/**< Glyph texture bitmap data buffer. */
 } ftgxCharData;
 
+class FreeTypeGX;
+
+/*! \struct ftgxGlyph_
+ *
+ * Character glyph resolved through a fallback chain, along with the face that owns it.
+ */
+typedef struct ftgxGlyph_ {
+	FreeTypeGX* face;	/**< Face whose glyph cache holds the character data. */
+	ftgxCharData* charData;	/**< Character data, NULL if no face in the chain can render the character. */
+} ftgxGlyph;
+
 #define FTGX_NULL				0x0000
 
 #define FTGX_JUSTIFY_MASK		0x000f
@@ -218,6 +231,9 @@ class FreeTypeGX {
 		uint32_t compatibilityMode;	/**< Compatibility mode for default tev operations and vertex descriptors. */
 		std::map<wchar_t, ftgxCharData> fontData; /**< Map which holds the glyph data structures for the corresponding characters. */
 
+		std::vector<FreeTypeGX*> fallbacks;	/**< Faces probed in order when this face has no glyph for a character. */
+		std::unordered_map<wchar_t, ftgxGlyph> glyphTable; /**< Memoized (face, glyph) resolutions, indexed by character. */
+
 		bool widthCachingEnabled = false;
 		std::map<const wchar_t*, int> cacheTextWidth;
 
@@ -236,7 +252,7 @@ class FreeTypeGX {
 		void loadGlyphData(FT_Bitmap *bmp, ftgxCharData *charData);
 
 		void drawTextFeature(float x, float y, int width, int format, float scaleX, float scaleY, float offsetX, float offsetY, float degrees);
-		void copyTextureToFramebuffer(GXTexObj *texObj, float texWidth, float texHeight, float screenX, float screenY, float scaleX, float scaleY, float offsetX, float offsetY, float degrees);
+		void copyTextureToFramebuffer(GXTexObj *texObj, float texWidth, float texHeight, float screenX, float screenY, float scaleX, float scaleY, float offsetX, float offsetY, float degrees, uint32_t color);
 		void copyFeatureToFramebuffer(float featureWidth, float featureHeight, float screenX, float screenY, float scaleX, float offsetX, float offsetY, float scaleY, float degrees);
 
 	public:
@@ -248,6 +264,7 @@ class FreeTypeGX {
 		bool setTextWidthCachingEnabled(bool enabled);
 		bool getTextWidthCachingEnabled();
 		void clearTextWidthCache();
+		void setFallbacks(const std::vector<FreeTypeGX*> &fallbacks);
 
 		static wchar_t* charToWideChar(char* p);
 		static wchar_t* charToWideChar(const char* p);
@@ -256,11 +273,17 @@ class FreeTypeGX {
 		int loadFont(uint8_t* fontBuffer, FT_Long bufferSize, FT_UInt pointSize, bool cacheAll = false);
 		int loadFont(const uint8_t* fontBuffer, FT_Long bufferSize, FT_UInt pointSize, bool cacheAll = false);
 
-		int drawText(float x, float y, const wchar_t *text, float scaleX = 1.0, float scaleY = 1.0, float offsetX = 0.0, float offsetY = 0.0, float degrees = 0.0, int textStyling = FTGX_NULL);
-		int drawText(float x, float y, const std::wstring &text, float scaleX = 1.0, float scaleY = 1.0, float offsetX = 0.0, float offsetY = 0.0, float degrees = 0.0, int textStyling = FTGX_NULL);
+		int drawText(float x, float y, const wchar_t *text, float scaleX = 1.0, float scaleY = 1.0, float offsetX = 0.0, float offsetY = 0.0, float degrees = 0.0, int textStyling = FTGX_NULL, const uint32_t *colors = NULL);
+		int drawText(float x, float y, const std::wstring &text, float scaleX = 1.0, float scaleY = 1.0, float offsetX = 0.0, float offsetY = 0.0, float degrees = 0.0, int textStyling = FTGX_NULL, const uint32_t *colors = NULL);
 
 		int getWidth(const wchar_t *text, float scaleX = 1.0);
 		int getHeight(const wchar_t *text, float scaleY = 1.0);
+
+		ftgxGlyph resolveCharacter(wchar_t character);
+		int getKerning(const ftgxGlyph &left, const ftgxGlyph &right);
+		int getLineHeight();
+		int getMaxAdvance();
+		FT_Bitmap* renderGlyph(const ftgxGlyph &glyph, int *top);
 };
 
 #endif /* FREETYPEGX_H_ */
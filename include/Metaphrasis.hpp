@@ -64,6 +64,7 @@
  * \li convertBufferToRGBA8
  * \li convertBufferToRGB565
  * \li convertBufferToRGB5A3
+ * \li convertBufferToCMPR
  *
  * \section sec_license License
  *
@@ -77,7 +78,9 @@
 #ifndef METAPHRASIS_H_
 #define METAPHRASIS_H_
 
+#ifdef GEKKO
 #include <gccore.h>
+#endif
 #include <stdint.h>
 #include <malloc.h>
 #include <string.h>
@@ -97,7 +100,7 @@
 #define RGBA_TO_IA8(x) x & 0x0000ffff
 #define RGBA_TO_RGB565(x) ((x & 0xf8000000) >> 16) | ((x & 0x00fc0000) >> 13) | ((x & 0x0000f800) >> 11)
 #define RGBA_TO_RGB555(x) ((x & 0xf8000000) >> 17) | ((x & 0x00f80000) >> 14) | ((x & 0x0000f800) >> 11) | 0x8000
-#define RGBA_TO_RGB444(x) ((x & 0xf0000000) >> 17) | ((x & 0x00f00000) >> 13) | ((x & 0x0000f000) >> 9) | ((x & 0x000000e0) >> 5)
+#define RGBA_TO_RGB444(x) ((x & 0x000000e0) << 7) | ((x & 0xf0000000) >> 20) | ((x & 0x00f00000) >> 16) | ((x & 0x0000f000) >> 12)
 #define RGBA_TO_RGB5A3(x) (x & 0xff) < 0xe0 ? RGBA_TO_RGB444(x) : RGBA_TO_RGB555(x)
 
 class Metaphrasis {
@@ -112,11 +115,27 @@ class Metaphrasis {
 		static uint32_t* convertBufferToRGBA8(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight);
 		static uint32_t* convertBufferToRGB565(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight);
 		static uint32_t* convertBufferToRGB5A3(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight);
+		static uint32_t* convertBufferToCMPR(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight);
+
+		static void convertBufferToI4(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight, uint32_t* dataBuffer);
+		static void convertBufferToI8(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight, uint32_t* dataBuffer);
+		static void convertBufferToIA4(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight, uint32_t* dataBuffer);
+		static void convertBufferToIA8(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight, uint32_t* dataBuffer);
+		static void convertBufferToRGBA8(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight, uint32_t* dataBuffer);
+		static void convertBufferToRGB565(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight, uint32_t* dataBuffer);
+		static void convertBufferToRGB5A3(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight, uint32_t* dataBuffer);
+		static void convertBufferToCMPR(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight, uint32_t* dataBuffer);
+
+		static void downsampleBuffer(const uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight, uint16_t bufferStride, uint32_t* mipmapBuffer);
+
+		static uint32_t* convertCMPRToBuffer(const uint8_t* cmprBuffer, uint16_t bufferWidth, uint16_t bufferHeight);
 
 		static uint8_t convertRGBAToIA4(uint32_t rgba);
 		static uint16_t convertRGBAToIA8(uint32_t rgba);
 		static uint16_t convertRGBAToRGB565(uint32_t rgba);
 		static uint16_t convertRGBAToRGB5A3(uint32_t rgba);
+		static void convertRGBABlockToCMPR(const uint32_t* rgba, uint16_t stride, uint8_t* block);
+		static void convertCMPRBlockToRGBA(const uint8_t* block, uint32_t* rgba, uint16_t stride);
 
 };
 
@@ -22,8 +22,14 @@
 #include "classes/audio/source.cpp"
 
 #include "classes/graphics/font.cpp"
+#include "classes/graphics/imagedata.cpp"
+#include "classes/graphics/particlesystem.cpp"
 #include "classes/graphics/quad.cpp"
 #include "classes/graphics/texture.cpp"
+#include "classes/graphics/tilemap.cpp"
+#include "classes/graphics/video.cpp"
+
+#include "classes/math/transform.cpp"
 
 #include "lib/FreeTypeGX.cpp"
 #include "lib/Metaphrasis.cpp"
@@ -32,6 +38,7 @@
 #include "modules/event.cpp"
 #include "modules/filesystem.cpp"
 #include "modules/graphics.cpp"
+#include "modules/loader.cpp"
 #include "modules/math.cpp"
 #include "modules/system.cpp"
 #include "modules/timer.cpp"
@@ -21,11 +21,26 @@
 
 // Libraries
 #include <FreeTypeGX.hpp>
+#include <grrlib-mod.h>
+#include <sol/sol.hpp>
 #include <iostream>
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <stdexcept>
+
+// Classes
+#include "imagedata.hpp"
+#include "texture.hpp"
 
 // Modules
 #include "../../modules/filesystem.hpp"
+#include "../../modules/graphics.hpp"
 
 // Header
 #include "font.hpp"
@@ -39,14 +54,170 @@ namespace graphics {
 // Local variables
 namespace {
 	constexpr int defaultFontSize = 12;
+	constexpr unsigned int directGlyphs = 256; // Code points looked up without the map
+	constexpr unsigned int maxBakeSize = 1024; // Largest texture GX can sample
+
+	enum class TextAlign { left, center, right, justify };
+
+	std::map<std::string, TextAlign> alignMap = {
+		{"left", TextAlign::left},
+		{"center", TextAlign::center},
+		{"right", TextAlign::right},
+		{"justify", TextAlign::justify}
+	};
+
+	// A run of text laid out on one line, end is exclusive and drops the space a wrap broke at
+	struct BakedLine {
+		size_t start, end;
+		int width;
+		unsigned int spaces;
+		bool paragraphEnd; // Justified lines only stretch when more text follows in the same paragraph
+	};
+
+	// Same spacing rules as FreeTypeGX::drawText, including tabs of four spaces. glyph is left empty for tabs.
+	int glyphAdvance(FreeTypeGX *fontSystem, wchar_t character, ftgxGlyph &previous, ftgxGlyph &glyph, int &kerning) {
+		kerning = 0;
+		glyph = {nullptr, nullptr};
+
+		if (character == L'\t') {
+			ftgxGlyph space = fontSystem->resolveCharacter(L' ');
+
+			return space.charData == nullptr ? 0 : space.charData->glyphAdvanceX * 4;
+		}
+
+		glyph = fontSystem->resolveCharacter(character);
+
+		if (glyph.charData == nullptr) return 0;
+
+		kerning = fontSystem->getKerning(previous, glyph);
+		previous = glyph;
+
+		return kerning + glyph.charData->glyphAdvanceX;
+	}
+
+	// Breaks at newlines, then at the last space before a line gets wider than wrap, or mid-word if there's none
+	std::vector<BakedLine> layoutText(FreeTypeGX *fontSystem, const std::wstring &text, int wrap) {
+		std::vector<BakedLine> lines;
+		size_t start = 0, lastSpace = std::wstring::npos;
+		int width = 0, widthAtSpace = 0, kerning;
+		unsigned int spaces = 0, spacesAtSpace = 0;
+		ftgxGlyph previous = {nullptr, nullptr}, glyph;
+
+		for (size_t i = 0; i <= text.size(); i++) {
+			if (i == text.size() || text[i] == L'\n') {
+				lines.push_back({start, i, width, spaces, true});
+			} else if (text[i] != L'\r') {
+				int advance = glyphAdvance(fontSystem, text[i], previous, glyph, kerning);
+
+				if (wrap <= 0 || width + advance <= wrap || i == start) {
+					if (text[i] == L' ') {
+						lastSpace = i;
+						widthAtSpace = width;
+						spacesAtSpace = spaces++;
+					}
+
+					width += advance;
+
+					continue;
+				}
+
+				if (text[i] == L' ') { // The word before it fits, so the overflowing space is the break
+					lines.push_back({start, i, width, spaces, false});
+				} else if (lastSpace != std::wstring::npos) {
+					lines.push_back({start, lastSpace, widthAtSpace, spacesAtSpace, false});
+					i = lastSpace;
+				} else {
+					lines.push_back({start, i, width, spaces, false});
+					i--;
+				}
+			} else {
+				continue;
+			}
+
+			start = i + 1;
+			lastSpace = std::wstring::npos;
+			width = 0;
+			spaces = 0;
+			previous = {nullptr, nullptr};
+		}
+
+		return lines;
+	}
+
+	// Glyphs are merged with max so overlapping antialiased edges don't saturate. Each row is a plain loop over contiguous
+	// bytes, which the compiler vectorizes on targets with byte SIMD.
+	void blitCoverage(std::vector<unsigned char> &coverage, int stride, int rows, int limit, const FT_Bitmap *bitmap, int x, int y) {
+		int left = std::max(0, -x), right = std::min<int>(bitmap->width, limit - x);
+		int top = std::max(0, -y), bottom = std::min<int>(bitmap->rows, rows - y);
+
+		for (int row = top; row < bottom; row++) {
+			const unsigned char *source = bitmap->buffer + row * bitmap->pitch;
+			unsigned char *destination = &coverage[(y + row) * stride + x];
+
+			for (int column = left; column < right; column++) {
+				destination[column] = std::max(destination[column], source[column]);
+			}
+		}
+	}
 }
 
+// Glyphs cut from a sprite sheet, separated by columns whose top pixel has the color of the top-left one
+struct ImageFont {
+	struct Glyph {
+		float u0, u1; // Texture coordinates
+		float width; // Pixels
+	};
+
+	Texture texture;
+	std::vector<Glyph> glyphs;
+	short directIndex[directGlyphs]; // -1 when missing
+	std::map<wchar_t, unsigned short> index;
+	float height;
+	float spacing; // Extra pixels after each glyph
+
+	ImageFont(const char *filename, const std::wstring &characters, int spacing) : texture(filename), spacing(spacing) {
+		ImageData pixels(texture);
+		std::tuple<unsigned char, unsigned char, unsigned char, unsigned char> separator = pixels.getPixel(0, 0);
+		unsigned int x = 0;
+
+		height = pixels.height;
+
+		for (unsigned int i = 0; i < directGlyphs; i++) directIndex[i] = -1;
+
+		for (wchar_t character : characters) {
+			while (x < pixels.width && pixels.getPixel(x, 0) == separator) x++;
+
+			unsigned int start = x;
+
+			while (x < pixels.width && pixels.getPixel(x, 0) != separator) x++;
+
+			if (x == start) { throw std::runtime_error("Image font has fewer glyphs than characters"); }
+
+			if (static_cast<unsigned int>(character) < directGlyphs)
+				directIndex[character] = glyphs.size();
+			else
+				index[character] = glyphs.size();
+
+			glyphs.push_back({static_cast<float>(start) / pixels.width, static_cast<float>(x) / pixels.width, static_cast<float>(x - start)});
+		}
+	}
+
+	const Glyph *find(wchar_t character) const {
+		if (static_cast<unsigned int>(character) < directGlyphs) return directIndex[character] < 0 ? nullptr : &glyphs[directIndex[character]];
+
+		auto entry = index.find(character);
+
+		return entry == index.end() ? nullptr : &glyphs[entry->second];
+	}
+};
+
 // Constructors
 Font::Font(unsigned int size) { // Load Vera.ttf as default font
 	instances = new int(1);
 	data = nullptr;
 	dataSize = nullptr;
 	fontSize = new int(size);
+	imageFont = nullptr;
 
 	fontSystem = new FreeTypeGX();
 
@@ -54,16 +225,40 @@ Font::Font(unsigned int size) { // Load Vera.ttf as default font
 }
 Font::Font() : Font(defaultFontSize) {} // Load Vera.ttf as default font (with default size)
 Font::Font(const char *filename, unsigned int size) { // Load TTF font
+	int fileSize;
+
+	filesystem::getFileData(filename, data, fileSize); // First, nothing is allocated yet if it throws
+
 	instances = new int(1);
-	dataSize = new int(0);
+	dataSize = new int(fileSize);
 	fontSize = new int(size);
+	imageFont = nullptr;
 
 	fontSystem = new FreeTypeGX();
 
-	filesystem::getFileData(filename, data, *dataSize);
 	fontSystem->loadFont(static_cast<unsigned char*>(data), *dataSize, *fontSize);
 }
 Font::Font(const char *filename) : Font(filename, defaultFontSize) {} // Load TTF font (with default size)
+Font::Font(void *data, int dataSize, unsigned int size) : data(data) { // Load TTF font from file data read elsewhere, taking ownership
+	instances = new int(1);
+	this->dataSize = new int(dataSize);
+	fontSize = new int(size);
+	imageFont = nullptr;
+
+	fontSystem = new FreeTypeGX();
+
+	fontSystem->loadFont(static_cast<unsigned char*>(data), *this->dataSize, *fontSize);
+}
+Font::Font(const char *filename, const std::wstring &glyphs, int spacing) { // Load image font, glyphs are cut once here
+	imageFont = new ImageFont(filename, glyphs, spacing);
+
+	instances = new int(1);
+	data = nullptr;
+	dataSize = nullptr;
+	fontSize = nullptr;
+
+	fontSystem = nullptr;
+}
 
 // Clone constructor
 Font::Font(const Font &other) {
@@ -71,15 +266,202 @@ Font::Font(const Font &other) {
 	data = other.data;
 	dataSize = other.dataSize;
 	fontSize = other.fontSize;
+	imageFont = other.imageFont;
 
 	(*instances)++;
 
+	if (imageFont != nullptr) {
+		fontSystem = nullptr;
+
+		return;
+	}
+
 	fontSystem = new FreeTypeGX();
 
 	if (data == nullptr)
 		fontSystem->loadFont(open_sans_ttf, open_sans_ttf_size, *fontSize);
 	else
 		fontSystem->loadFont(static_cast<unsigned char *>(data), *dataSize, *fontSize);
+
+	fallbacks = other.fallbacks;
+
+	applyFallbacks();
+}
+
+// Fallbacks
+void Font::applyFallbacks() {
+	std::vector<FreeTypeGX *> faces;
+
+	for (const sol::object &fallback : fallbacks) {
+		faces.push_back(fallback.as<Font &>().fontSystem);
+	}
+
+	fontSystem->setFallbacks(faces);
+}
+// Walks the fallback chain. Chains never loop, setFallbacks keeps it that way, so this always ends
+bool Font::reachesFallback(const Font *font) const {
+	for (const sol::object &fallback : fallbacks) {
+		const Font &next = fallback.as<Font &>();
+
+		if (&next == font || next.reachesFallback(font)) return true;
+	}
+
+	return false;
+}
+void Font::setFallbacks(sol::variadic_args fallbacks) {
+	if (fontSystem == nullptr) { throw std::runtime_error("Image fonts can't have fallbacks"); }
+
+	std::vector<sol::object> objects;
+
+	for (const sol::object &fallback : fallbacks) {
+		if (!fallback.is<Font>()) { throw std::runtime_error("Fallbacks must be Fonts"); }
+
+		const Font &font = fallback.as<Font &>();
+
+		if (font.fontSystem == nullptr) { throw std::runtime_error("Image fonts can't be used as fallbacks"); }
+		if (&font == this) { throw std::runtime_error("A font can't be its own fallback"); }
+		if (font.reachesFallback(this)) { throw std::runtime_error("Fallbacks can't loop back to the font"); } // Would also keep both alive forever
+
+		objects.push_back(fallback);
+	}
+
+	this->fallbacks = std::move(objects);
+
+	applyFallbacks();
+}
+
+// Baking
+Texture Font::bake(const std::wstring &text) { return bake3(text, 0, "left", "i8"); }
+Texture Font::bake1(const std::wstring &text, int wrap) { return bake3(text, wrap, "left", "i8"); }
+Texture Font::bake2(const std::wstring &text, int wrap, const std::string &align) { return bake3(text, wrap, align, "i8"); }
+Texture Font::bake3(const std::wstring &text, int wrap, const std::string &align, const std::string &format) {
+	if (fontSystem == nullptr) { throw std::runtime_error("Image fonts can't be baked"); }
+	if (alignMap.count(align) == 0) { throw std::runtime_error("Invalid alignment: " + align); }
+	if (format != "i8" && format != "ia4") { throw std::runtime_error("Baked text must use i8 or ia4"); }
+
+	TextAlign textAlign = alignMap[align];
+	std::vector<BakedLine> lines = layoutText(fontSystem, text, wrap);
+	int lineHeight = fontSystem->getLineHeight();
+	int layoutWidth = wrap;
+
+	if (wrap <= 0) {
+		layoutWidth = 0;
+
+		for (const BakedLine &line : lines) layoutWidth = std::max(layoutWidth, line.width);
+	}
+
+	// Glyphs may overhang their advance and descend below the last line, so leave a line of slack on both axes and
+	// trim the texture to what was actually covered
+	int stride = (layoutWidth + lineHeight + 7) & ~7;
+	int rows = (static_cast<int>(lines.size()) + 1) * lineHeight;
+	int limit = wrap > 0 ? wrap : stride;
+	int right = layoutWidth, bottom = static_cast<int>(lines.size()) * lineHeight;
+	std::vector<unsigned char> coverage(stride * ((rows + 3) & ~3), 0);
+
+	for (size_t i = 0; i < lines.size(); i++) {
+		const BakedLine &line = lines[i];
+		int baseline = (i + 1) * lineHeight;
+		int extra = layoutWidth - line.width, kerning;
+		float penX = 0.0f, gap = 0.0f;
+		ftgxGlyph previous = {nullptr, nullptr}, glyph;
+
+		switch (textAlign) {
+			case TextAlign::center: penX = extra / 2; break;
+			case TextAlign::right: penX = extra; break;
+			case TextAlign::justify: if (!line.paragraphEnd && line.spaces > 0) gap = static_cast<float>(extra) / line.spaces; break;
+			default: break;
+		}
+
+		for (size_t j = line.start; j < line.end; j++) {
+			if (text[j] == L'\r') continue;
+
+			int advance = glyphAdvance(fontSystem, text[j], previous, glyph, kerning);
+
+			if (glyph.charData != nullptr && text[j] != L' ') {
+				int top;
+				FT_Bitmap *bitmap = fontSystem->renderGlyph(glyph, &top);
+				int x = static_cast<int>(penX) + kerning, y = baseline - top;
+
+				if (bitmap != nullptr) {
+					blitCoverage(coverage, stride, rows, limit, bitmap, x, y);
+
+					right = std::max(right, std::min<int>(x + bitmap->width, limit));
+					bottom = std::max(bottom, std::min<int>(y + bitmap->rows, rows));
+				}
+			}
+
+			penX += advance;
+
+			if (text[j] == L' ') penX += gap;
+		}
+	}
+
+	unsigned int width = std::max(right, 1), height = std::max(bottom, 1);
+
+	if (width > maxBakeSize || height > maxBakeSize) { throw std::runtime_error("Baked text is larger than 1024x1024"); }
+
+	// Both formats use 8x4 tiles of one byte per texel
+	ImageData imageData(width, height, format);
+	unsigned char *tile = imageData.data;
+
+	for (unsigned int tileY = 0; tileY < height; tileY += 4) {
+		for (unsigned int tileX = 0; tileX < width; tileX += 8) {
+			for (unsigned int row = 0; row < 4; row++) {
+				const unsigned char *source = &coverage[(tileY + row) * stride + tileX];
+
+				if (imageData.format == GX_TF_I8) {
+					std::memcpy(tile, source, 8);
+				} else { // Full intensity, coverage as alpha, like ImageData::setPixel
+					for (unsigned int i = 0; i < 8; i++) tile[i] = 0xf0 | (source[i] >> 4);
+				}
+
+				tile += 8;
+			}
+		}
+	}
+
+	return Texture(imageData);
+}
+
+// Rendering
+unsigned int Font::printImage(const std::wstring &text, const Mtx matrix, unsigned int color, const uint32_t *colors) const {
+	float height = imageFont->height;
+	float v1 = height / imageFont->texture.texture->height;
+	float penX = 0.0f, penY = 0.0f;
+	unsigned int drawn = 0;
+
+	for (size_t i = 0; i < text.size(); i++) {
+		wchar_t character = text[i];
+
+		if (character == L'\n') {
+			penX = 0.0f;
+			penY += height;
+
+			continue;
+		}
+
+		const ImageFont::Glyph *glyph = imageFont->find(character);
+
+		if (glyph == nullptr) continue;
+
+		float right = penX + glyph->width, bottom = penY + height;
+		float corners[4][2] = {
+			{matrix[0][0] * penX + matrix[0][1] * penY + matrix[0][3], matrix[1][0] * penX + matrix[1][1] * penY + matrix[1][3]},
+			{matrix[0][0] * right + matrix[0][1] * penY + matrix[0][3], matrix[1][0] * right + matrix[1][1] * penY + matrix[1][3]},
+			{matrix[0][0] * right + matrix[0][1] * bottom + matrix[0][3], matrix[1][0] * right + matrix[1][1] * bottom + matrix[1][3]},
+			{matrix[0][0] * penX + matrix[0][1] * bottom + matrix[0][3], matrix[1][0] * penX + matrix[1][1] * bottom + matrix[1][3]}
+		};
+
+		if (love::graphics::isOnScreen(corners)) {
+			love::graphics::batchQuad(imageFont->texture, corners, glyph->u0, 0.0f, glyph->u1, v1, colors != nullptr ? colors[i] : color);
+
+			drawn++;
+		}
+
+		penX = right + imageFont->spacing;
+	}
+
+	return drawn;
 }
 
 // Object functions
@@ -90,9 +472,12 @@ void Font::release() { delete this; }
 
 // Destructor
 Font::~Font() {
+	love::graphics::waitForFrame(); // Glyph textures may still be drawing
+
 	delete fontSystem;
 
 	if (--(*instances) == 0) {
+		delete imageFont;
 		delete fontSize;
 		delete dataSize;
 		std::free(data);
@@ -23,27 +23,56 @@
 
 // Libraries
 #include <FreeTypeGX.hpp>
+#include <grrlib-mod.h>
+#include <sol/sol.hpp>
+#include <string>
+#include <vector>
+
+// Classes
+#include "texture.hpp"
 
 namespace love {
 namespace graphics {
 
+struct ImageFont;
+
 class Font {
 	private:
 		int *instances;
 		void *data;
 		int *dataSize;
 		int *fontSize;
+		ImageFont *imageFont; // Shared by clones, nullptr for TTF fonts
+		std::vector<sol::object> fallbacks; // Keeps the fallback Fonts alive while their faces are in use
+
+		void applyFallbacks();
+		bool reachesFallback(const Font *font) const;
 
 	public:
-		FreeTypeGX *fontSystem;
+		FreeTypeGX *fontSystem; // nullptr for image fonts
 
 		Font(unsigned int size);
 		Font();
 		Font(const char *filename, unsigned int size);
 		Font(const char *filename);
+		Font(void *data, int dataSize, unsigned int size);
+		Font(const char *filename, const std::wstring &glyphs, int spacing);
 
 		Font(const Font &other);
 
+		// Characters missing from this font are drawn with the first fallback that has them
+		void setFallbacks(sol::variadic_args fallbacks);
+
+		// Renders text into a one-byte-per-texel texture, wrapped at wrap pixels unless it's 0 or less
+		Texture bake(const std::wstring &text);
+		Texture bake1(const std::wstring &text, int wrap);
+		Texture bake2(const std::wstring &text, int wrap, const std::string &align);
+		Texture bake3(const std::wstring &text, int wrap, const std::string &align, const std::string &format);
+
+		// Batches the glyphs of an image font under matrix, returns the number of glyphs on screen. colors, if given,
+		// holds one color per character and replaces color.
+		unsigned int printImage(const std::wstring &text, const Mtx matrix, unsigned int color, const uint32_t *colors = nullptr) const;
+
 		Font *clone();
 		void release();
 
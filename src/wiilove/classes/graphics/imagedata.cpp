@@ -0,0 +1,278 @@
+/* WiiLÖVE ImageData class
+ *
+ * This file is part of WiiLÖVE.
+ *
+ * Copyright (C) 2022  HTV04
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+// Libraries
+#include <grrlib-mod.h>
+#include <png.h>
+#include <sol/sol.hpp>
+#include <malloc.h>
+#include <csetjmp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <stdexcept>
+
+// Classes
+#include "texture.hpp"
+
+// Header
+#include "imagedata.hpp"
+
+namespace love {
+namespace graphics {
+
+// Local variables
+namespace {
+	// Bits of a 4/5-bit channel repeated to fill 8 bits, like the GX texture unit does
+	inline unsigned char expand3(unsigned int value) { return (value << 5) | (value << 2) | (value >> 1); }
+	inline unsigned char expand4(unsigned int value) { return (value << 4) | value; }
+	inline unsigned char expand5(unsigned int value) { return (value << 3) | (value >> 2); }
+	inline unsigned char expand6(unsigned int value) { return (value << 2) | (value >> 4); }
+
+	void checkBounds(const ImageData &imageData, unsigned int x, unsigned int y, unsigned int width, unsigned int height) {
+		if (x + width > imageData.width || y + height > imageData.height) {
+			throw std::runtime_error("Pixel region out of bounds");
+		}
+	}
+}
+
+// Constructor
+ImageData::ImageData(unsigned int width, unsigned int height, const std::string &format) : width(width), height(height) {
+	if (!getTextureFormat(format, this->format)) { throw std::runtime_error("Invalid texture format: " + format); }
+	if (this->format == GX_TF_CMPR) { throw std::runtime_error("ImageData can't use compressed formats"); }
+
+	size = GX_GetTexBufferSize(width, height, this->format, GX_FALSE, 0);
+	data = static_cast<unsigned char *>(memalign(32, size));
+
+	std::memset(data, 0, size);
+
+	switch (this->format) {
+		case GX_TF_I4:
+			tileWidth = 8;
+			tileHeight = 8;
+			break;
+		case GX_TF_I8:
+		case GX_TF_IA4:
+			tileWidth = 8;
+			tileHeight = 4;
+			break;
+		default:
+			tileWidth = 4;
+			tileHeight = 4;
+	}
+	tileSize = this->format == GX_TF_RGBA8 ? 64 : 32;
+}
+ImageData::ImageData(const Texture &texture) : ImageData(texture.texture->width, texture.texture->height, getTextureFormatName(texture.format)) {
+	texture.makeResident();
+
+	std::memcpy(data, texture.texture->data, size);
+}
+
+// Copy constructor
+ImageData::ImageData(const ImageData &other) {
+	width = other.width;
+	height = other.height;
+	format = other.format;
+	tileWidth = other.tileWidth;
+	tileHeight = other.tileHeight;
+	tileSize = other.tileSize;
+	size = other.size;
+
+	data = static_cast<unsigned char *>(memalign(32, size));
+	std::memcpy(data, other.data, size);
+}
+
+// ImageData properties
+unsigned int ImageData::getWidth() { return width; }
+unsigned int ImageData::getHeight() { return height; }
+std::pair<unsigned int, unsigned int> ImageData::getDimensions() {
+	return std::make_pair(width, height);
+}
+std::string ImageData::getFormat() { return getTextureFormatName(format); }
+
+// Pixel access
+unsigned int ImageData::getTileOffset(unsigned int x, unsigned int y) const {
+	unsigned int tilesPerRow = (width + tileWidth - 1) / tileWidth;
+
+	return ((y / tileHeight) * tilesPerRow + x / tileWidth) * tileSize;
+}
+std::tuple<unsigned char, unsigned char, unsigned char, unsigned char> ImageData::getPixel(unsigned int x, unsigned int y) {
+	checkBounds(*this, x, y, 1, 1);
+
+	const unsigned char *tile = data + getTileOffset(x, y);
+	unsigned int texel = (y % tileHeight) * tileWidth + x % tileWidth;
+	unsigned int value;
+
+	switch (format) {
+		case GX_TF_I4:
+			value = expand4((tile[texel >> 1] >> ((texel & 1) ? 0 : 4)) & 0xf);
+
+			return std::make_tuple(value, value, value, value);
+		case GX_TF_I8:
+			return std::make_tuple(tile[texel], tile[texel], tile[texel], tile[texel]);
+		case GX_TF_IA4:
+			value = expand4(tile[texel] >> 4);
+
+			return std::make_tuple(value, value, value, expand4(tile[texel] & 0xf));
+		case GX_TF_IA8:
+			return std::make_tuple(tile[texel * 2], tile[texel * 2], tile[texel * 2], tile[texel * 2 + 1]);
+		case GX_TF_RGB565:
+			value = (tile[texel * 2] << 8) | tile[texel * 2 + 1];
+
+			return std::make_tuple(expand5(value >> 11), expand6((value >> 5) & 0x3f), expand5(value & 0x1f), 255);
+		case GX_TF_RGB5A3:
+			value = (tile[texel * 2] << 8) | tile[texel * 2 + 1];
+
+			if (value & 0x8000) {
+				return std::make_tuple(expand5((value >> 10) & 0x1f), expand5((value >> 5) & 0x1f), expand5(value & 0x1f), 255);
+			}
+
+			return std::make_tuple(expand4((value >> 8) & 0xf), expand4((value >> 4) & 0xf), expand4(value & 0xf), expand3((value >> 12) & 0x7));
+		default: // RGBA8, AR pairs then GB pairs
+			return std::make_tuple(tile[texel * 2 + 1], tile[32 + texel * 2], tile[32 + texel * 2 + 1], tile[texel * 2]);
+	}
+}
+void ImageData::setPixel(unsigned int x, unsigned int y, unsigned char r, unsigned char g, unsigned char b, unsigned char a) {
+	checkBounds(*this, x, y, 1, 1);
+
+	unsigned char *tile = data + getTileOffset(x, y);
+	unsigned int texel = (y % tileHeight) * tileWidth + x % tileWidth;
+	unsigned int value;
+
+	switch (format) { // Intensity comes from red, like textures converted on load
+		case GX_TF_I4:
+			if (texel & 1)
+				tile[texel >> 1] = (tile[texel >> 1] & 0xf0) | (r >> 4);
+			else
+				tile[texel >> 1] = (tile[texel >> 1] & 0x0f) | (r & 0xf0);
+			break;
+		case GX_TF_I8:
+			tile[texel] = r;
+			break;
+		case GX_TF_IA4:
+			tile[texel] = (r & 0xf0) | (a >> 4);
+			break;
+		case GX_TF_IA8:
+			tile[texel * 2] = r;
+			tile[texel * 2 + 1] = a;
+			break;
+		case GX_TF_RGB565:
+			value = ((r & 0xf8) << 8) | ((g & 0xfc) << 3) | (b >> 3);
+
+			tile[texel * 2] = value >> 8;
+			tile[texel * 2 + 1] = value & 0xff;
+			break;
+		case GX_TF_RGB5A3:
+			if (a >= 0xe0)
+				value = 0x8000 | ((r & 0xf8) << 7) | ((g & 0xf8) << 2) | (b >> 3);
+			else
+				value = ((a & 0xe0) << 7) | ((r & 0xf0) << 4) | (g & 0xf0) | (b >> 4);
+
+			tile[texel * 2] = value >> 8;
+			tile[texel * 2 + 1] = value & 0xff;
+			break;
+		default:
+			tile[texel * 2] = a;
+			tile[texel * 2 + 1] = r;
+			tile[32 + texel * 2] = g;
+			tile[32 + texel * 2 + 1] = b;
+	}
+}
+void ImageData::mapPixel(sol::function function) {
+	mapPixel1(function, 0, 0, width, height);
+}
+void ImageData::mapPixel1(sol::function function, unsigned int x, unsigned int y, unsigned int width, unsigned int height) {
+	checkBounds(*this, x, y, width, height);
+
+	for (unsigned int pixelY = y; pixelY < y + height; pixelY++) {
+		for (unsigned int pixelX = x; pixelX < x + width; pixelX++) {
+			unsigned char r, g, b, a;
+
+			std::tie(r, g, b, a) = getPixel(pixelX, pixelY);
+			std::tie(r, g, b, a) = function.call<std::tuple<unsigned char, unsigned char, unsigned char, unsigned char>>(pixelX, pixelY, r, g, b, a);
+
+			setPixel(pixelX, pixelY, r, g, b, a);
+		}
+	}
+}
+
+// Encoding
+void writePNG(const unsigned char *data, unsigned int width, unsigned int height, bool alpha, const std::string &path) {
+	unsigned int channels = alpha ? 4 : 3;
+	unsigned int tilesPerRow = (width + 3) / 4;
+	std::vector<unsigned char> row(width * channels);
+	FILE *file = std::fopen(path.c_str(), "wb");
+
+	if (file == nullptr) { throw std::runtime_error("Could not open " + path); }
+
+	png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+	png_infop info = png_create_info_struct(png);
+
+	if (setjmp(png_jmpbuf(png))) { // libpng errors land here
+		png_destroy_write_struct(&png, &info);
+		std::fclose(file);
+
+		throw std::runtime_error("Could not encode " + path);
+	}
+
+	png_init_io(png, file);
+	png_set_IHDR(png, info, width, height, 8, alpha ? PNG_COLOR_TYPE_RGBA : PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+	png_write_info(png, info);
+
+	for (unsigned int y = 0; y < height; y++) { // De-tile one row at a time, AR pairs then GB pairs per 4x4 tile
+		unsigned char *out = row.data();
+
+		for (unsigned int x = 0; x < width; x++) {
+			const unsigned char *tile = data + ((y / 4) * tilesPerRow + x / 4) * 64;
+			unsigned int texel = (y % 4) * 4 + x % 4;
+
+			*out++ = tile[texel * 2 + 1];
+			*out++ = tile[32 + texel * 2];
+			*out++ = tile[32 + texel * 2 + 1];
+			if (alpha) *out++ = tile[texel * 2];
+		}
+
+		png_write_row(png, row.data());
+	}
+
+	png_write_end(png, info);
+	png_destroy_write_struct(&png, &info);
+
+	if (std::fclose(file) != 0) { throw std::runtime_error("Could not write " + path); }
+}
+
+// Object functions
+ImageData *ImageData::clone() {
+	return new ImageData(*this);
+}
+void ImageData::release() { delete this; }
+
+// Destructor
+ImageData::~ImageData() {
+	std::free(data);
+}
+
+} // graphics
+} // love
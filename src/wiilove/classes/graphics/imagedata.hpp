@@ -0,0 +1,74 @@
+/* WiiLÖVE ImageData class
+ *
+ * This file is part of WiiLÖVE.
+ *
+ * Copyright (C) 2022  HTV04
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Libraries
+#include <sol/sol.hpp>
+#include <string>
+#include <tuple>
+#include <utility>
+
+// Classes
+#include "texture.hpp"
+
+namespace love {
+namespace graphics {
+
+// Pixels kept in a GX texture format's tiled layout, so they can be copied into a texture as is
+class ImageData {
+	public:
+		unsigned int width, height;
+		unsigned char format; // GX texture format of the data
+		unsigned int tileWidth, tileHeight;
+		unsigned int tileSize; // Bytes per tile
+		unsigned int size; // Bytes used by the data
+		unsigned char *data;
+
+		ImageData(unsigned int width, unsigned int height, const std::string &format);
+		ImageData(const Texture &texture);
+
+		ImageData(const ImageData &other);
+
+		unsigned int getWidth();
+		unsigned int getHeight();
+		std::pair<unsigned int, unsigned int> getDimensions();
+		std::string getFormat();
+
+		std::tuple<unsigned char, unsigned char, unsigned char, unsigned char> getPixel(unsigned int x, unsigned int y);
+		void setPixel(unsigned int x, unsigned int y, unsigned char r, unsigned char g, unsigned char b, unsigned char a);
+		void mapPixel(sol::function function);
+		void mapPixel1(sol::function function, unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+
+		unsigned int getTileOffset(unsigned int x, unsigned int y) const; // Byte offset of the tile holding a pixel
+
+		ImageData *clone();
+		void release();
+
+		~ImageData();
+};
+
+// Writes tiled RGBA8 pixels to a PNG file, optionally without alpha. Touches no shared state, so the loader
+// thread can run it.
+void writePNG(const unsigned char *data, unsigned int width, unsigned int height, bool alpha, const std::string &path);
+
+} // graphics
+} // love
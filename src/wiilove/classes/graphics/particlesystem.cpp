@@ -0,0 +1,331 @@
+/* WiiLÖVE ParticleSystem class
+ *
+ * This file is part of WiiLÖVE.
+ *
+ * Copyright (C) 2022  HTV04
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+
+// Libraries
+#include <grrlib-mod.h>
+#include <ogc/lwp_watchdog.h>
+#include <sol/sol.hpp>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <tuple>
+#include <vector>
+#include <stdexcept>
+
+// Classes
+#include "quad.hpp"
+#include "texture.hpp"
+
+// Modules
+#include "../../modules/graphics.hpp"
+
+// Header
+#include "particlesystem.hpp"
+
+namespace love {
+namespace graphics {
+
+// Local variables
+namespace {
+	constexpr unsigned int maxLifetimeValues = 8; // Colors and sizes over lifetime, like LÖVE
+
+	// Linear interpolation through evenly spaced values with the given stride, at t from 0 to 1
+	inline const float *sampleLifetime(const std::vector<float> &values, unsigned int stride, float t, float &fraction) {
+		unsigned int steps = values.size() / stride - 1;
+		float position = t * steps;
+		unsigned int index = std::min<unsigned int>(position, steps > 0 ? steps - 1 : 0);
+
+		fraction = steps > 0 ? position - index : 0.0f;
+
+		return &values[index * stride];
+	}
+}
+
+// Constructor
+ParticleSystem::ParticleSystem(const Texture &texture, unsigned int maxParticles) : texture(texture), maxParticles(maxParticles) {
+	if (maxParticles == 0) { throw std::runtime_error("ParticleSystem size must be at least 1"); }
+
+	for (std::vector<float> *values : {&positionX, &positionY, &velocityX, &velocityY, &accelerationX, &accelerationY, &progress, &progressRate, &angle, &spin}) {
+		values->resize(maxParticles);
+	}
+
+	count = 0;
+
+	emitterX = emitterY = 0.0f;
+	emissionRate = emitCounter = 0.0f;
+	emitterLifetime = emitterLife = -1.0f;
+	active = true;
+
+	direction = spread = 0.0f;
+	speedMin = speedMax = 0.0f;
+	lifetimeMin = lifetimeMax = 1.0f;
+	accelerationXMin = accelerationYMin = accelerationXMax = accelerationYMax = 0.0f;
+	spinMin = spinMax = 0.0f;
+	rotationMin = rotationMax = 0.0f;
+
+	colors = {255.0f, 255.0f, 255.0f, 255.0f};
+	sizes = {1.0f};
+
+	randomState = gettime() | 1;
+}
+
+// Clone constructor
+ParticleSystem::ParticleSystem(const ParticleSystem &other) = default;
+
+// Private helpers
+float ParticleSystem::random(float min, float max) { // xorshift32, cheaper than a standard engine per particle
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+
+	return min + (max - min) * (randomState >> 8) * (1.0f / 16777216.0f);
+}
+void ParticleSystem::spawn() {
+	float particleDirection = DegToRad(direction + random(-spread, spread) * 0.5f);
+	float speed = random(speedMin, speedMax);
+
+	positionX[count] = emitterX;
+	positionY[count] = emitterY;
+	velocityX[count] = std::cos(particleDirection) * speed;
+	velocityY[count] = std::sin(particleDirection) * speed;
+	accelerationX[count] = random(accelerationXMin, accelerationXMax);
+	accelerationY[count] = random(accelerationYMin, accelerationYMax);
+	progress[count] = 0.0f;
+	progressRate[count] = 1.0f / std::max(random(lifetimeMin, lifetimeMax), 0.001f);
+	angle[count] = random(rotationMin, rotationMax);
+	spin[count] = random(spinMin, spinMax);
+
+	count++;
+}
+
+// Simulation
+void ParticleSystem::emit(unsigned int amount) {
+	amount = std::min(amount, maxParticles - count);
+
+	for (unsigned int i = 0; i < amount; i++) spawn();
+}
+void ParticleSystem::reset() {
+	count = 0;
+	emitCounter = 0.0f;
+	emitterLife = emitterLifetime;
+}
+void ParticleSystem::start() {
+	active = true;
+}
+void ParticleSystem::stop() {
+	active = false;
+	emitterLife = emitterLifetime;
+	emitCounter = 0.0f;
+}
+void ParticleSystem::update(float dt) {
+	// Integrate every particle in one branch-free pass, restrict lets the compiler keep the arrays apart
+	float *__restrict x = positionX.data(), *__restrict y = positionY.data();
+	float *__restrict vx = velocityX.data(), *__restrict vy = velocityY.data();
+	const float *__restrict ax = accelerationX.data(), *__restrict ay = accelerationY.data();
+	float *__restrict t = progress.data();
+	const float *__restrict rate = progressRate.data();
+	float *__restrict a = angle.data();
+	const float *__restrict s = spin.data();
+
+	for (unsigned int i = 0; i < count; i++) {
+		vx[i] += ax[i] * dt;
+		vy[i] += ay[i] * dt;
+		x[i] += vx[i] * dt;
+		y[i] += vy[i] * dt;
+		t[i] += rate[i] * dt;
+		a[i] += s[i] * dt;
+	}
+
+	// Remove expired particles by moving the last one into their slot
+	for (unsigned int i = 0; i < count;) {
+		if (t[i] < 1.0f) {
+			i++;
+
+			continue;
+		}
+
+		count--;
+
+		x[i] = x[count];
+		y[i] = y[count];
+		vx[i] = vx[count];
+		vy[i] = vy[count];
+		accelerationX[i] = ax[count];
+		accelerationY[i] = ay[count];
+		t[i] = t[count];
+		progressRate[i] = rate[count];
+		a[i] = a[count];
+		spin[i] = s[count];
+	}
+
+	if (!active) return;
+
+	emitCounter += emissionRate * dt;
+
+	while (emitCounter >= 1.0f && count < maxParticles) {
+		spawn();
+
+		emitCounter -= 1.0f;
+	}
+
+	emitCounter = std::min(emitCounter, 1.0f); // Don't bank particles while the buffer is full
+
+	if (emitterLife >= 0.0f) {
+		emitterLife -= dt;
+
+		if (emitterLife < 0.0f) stop();
+	}
+}
+
+// ParticleSystem properties
+unsigned int ParticleSystem::getBufferSize() { return maxParticles; }
+unsigned int ParticleSystem::getCount() { return count; }
+bool ParticleSystem::isActive() { return active; }
+
+std::tuple<float, float, float, float> ParticleSystem::getLinearAcceleration() {
+	return std::make_tuple(accelerationXMin, accelerationYMin, accelerationXMax, accelerationYMax);
+}
+float ParticleSystem::getDirection() { return direction; }
+float ParticleSystem::getEmissionRate() { return emissionRate; }
+float ParticleSystem::getEmitterLifetime() { return emitterLifetime; }
+std::pair<float, float> ParticleSystem::getParticleLifetime() { return std::make_pair(lifetimeMin, lifetimeMax); }
+std::pair<float, float> ParticleSystem::getPosition() { return std::make_pair(emitterX, emitterY); }
+std::pair<float, float> ParticleSystem::getRotation() { return std::make_pair(rotationMin, rotationMax); }
+std::pair<float, float> ParticleSystem::getSpeed() { return std::make_pair(speedMin, speedMax); }
+std::pair<float, float> ParticleSystem::getSpin() { return std::make_pair(spinMin, spinMax); }
+float ParticleSystem::getSpread() { return spread; }
+Texture ParticleSystem::getTexture() { return texture; }
+void ParticleSystem::setColors(sol::variadic_args values) {
+	if (values.size() == 0 || values.size() % 4 != 0 || values.size() > maxLifetimeValues * 4) {
+		throw std::runtime_error("Colors must be given as 1 to 8 sets of r, g, b, a");
+	}
+
+	colors.clear();
+
+	for (unsigned int i = 0; i < values.size(); i++) colors.push_back(values.get<float>(i));
+}
+void ParticleSystem::setDirection(float direction) { this->direction = direction; }
+void ParticleSystem::setEmissionRate(float rate) {
+	if (rate < 0.0f) { throw std::runtime_error("Invalid emission rate"); }
+
+	emissionRate = rate;
+}
+void ParticleSystem::setEmitterLifetime(float lifetime) {
+	emitterLifetime = emitterLife = lifetime;
+}
+void ParticleSystem::setLinearAcceleration(float xMin, float yMin, float xMax, float yMax) {
+	accelerationXMin = xMin;
+	accelerationYMin = yMin;
+	accelerationXMax = xMax;
+	accelerationYMax = yMax;
+}
+void ParticleSystem::setParticleLifetime(float min, float max) {
+	lifetimeMin = min;
+	lifetimeMax = max;
+}
+void ParticleSystem::setParticleLifetime1(float lifetime) { setParticleLifetime(lifetime, lifetime); }
+void ParticleSystem::setPosition(float x, float y) {
+	emitterX = x;
+	emitterY = y;
+}
+void ParticleSystem::setQuads(sol::variadic_args values) {
+	quads.clear();
+
+	for (unsigned int i = 0; i < values.size(); i++) quads.push_back(*values.get<const Quad &>(i).texturePart);
+}
+void ParticleSystem::setRotation(float min, float max) {
+	rotationMin = min;
+	rotationMax = max;
+}
+void ParticleSystem::setRotation1(float rotation) { setRotation(rotation, rotation); }
+void ParticleSystem::setSizes(sol::variadic_args values) {
+	if (values.size() == 0 || values.size() > maxLifetimeValues) { throw std::runtime_error("Sizes must be given as 1 to 8 values"); }
+
+	sizes.clear();
+
+	for (unsigned int i = 0; i < values.size(); i++) sizes.push_back(values.get<float>(i));
+}
+void ParticleSystem::setSpeed(float min, float max) {
+	speedMin = min;
+	speedMax = max;
+}
+void ParticleSystem::setSpeed1(float speed) { setSpeed(speed, speed); }
+void ParticleSystem::setSpin(float min, float max) {
+	spinMin = min;
+	spinMax = max;
+}
+void ParticleSystem::setSpin1(float spin) { setSpin(spin, spin); }
+void ParticleSystem::setSpread(float spread) { this->spread = spread; }
+
+// Rendering, every particle is a quad centered on its position
+void ParticleSystem::render(const Mtx matrix, unsigned int color) const {
+	const GRRLIB_texturePart &whole = texture.texture->part;
+	float tint[4] = {GRRLIB_R(color) / 255.0f, GRRLIB_G(color) / 255.0f, GRRLIB_B(color) / 255.0f, GRRLIB_A(color) / 255.0f};
+	float corners[4][2];
+
+	for (unsigned int i = 0; i < count; i++) {
+		float t = std::min(progress[i], 1.0f), fraction;
+		const float *from = sampleLifetime(colors, 4, t, fraction);
+		const float *to = colors.size() > 4 ? from + 4 : from;
+		unsigned char rgba[4];
+
+		for (int channel = 0; channel < 4; channel++) {
+			rgba[channel] = (from[channel] + (to[channel] - from[channel]) * fraction) * tint[channel];
+		}
+
+		const float *size = sampleLifetime(sizes, 1, t, fraction);
+		float scale = sizes.size() > 1 ? size[0] + (size[1] - size[0]) * fraction : size[0];
+
+		const GRRLIB_texturePart &part = quads.empty() ? whole : quads[std::min<unsigned int>(t * quads.size(), quads.size() - 1)];
+		float halfWidth = part.width * scale * 0.5f, halfHeight = part.height * scale * 0.5f;
+		float cosA = 1.0f, sinA = 0.0f;
+
+		if (angle[i] != 0.0f) {
+			cosA = std::cos(DegToRad(angle[i]));
+			sinA = std::sin(DegToRad(angle[i]));
+		}
+
+		// Rotated half extents, the corners are the position plus or minus their sums
+		float ux = cosA * halfWidth, uy = sinA * halfWidth;
+		float vx = -sinA * halfHeight, vy = cosA * halfHeight;
+		float offsets[4][2] = {{-ux - vx, -uy - vy}, {ux - vx, uy - vy}, {ux + vx, uy + vy}, {-ux + vx, -uy + vy}};
+
+		for (int corner = 0; corner < 4; corner++) {
+			float localX = positionX[i] + offsets[corner][0], localY = positionY[i] + offsets[corner][1];
+
+			corners[corner][0] = matrix[0][0] * localX + matrix[0][1] * localY + matrix[0][3];
+			corners[corner][1] = matrix[1][0] * localX + matrix[1][1] * localY + matrix[1][3];
+		}
+
+		love::graphics::batchQuad(texture, corners, part.x / part.textureWidth, part.y / part.textureHeight, (part.x + part.width) / part.textureWidth, (part.y + part.height) / part.textureHeight,
+			GRRLIB_RGBA(rgba[0], rgba[1], rgba[2], rgba[3]));
+	}
+}
+
+// Object functions
+ParticleSystem *ParticleSystem::clone() {
+	return new ParticleSystem(*this);
+}
+void ParticleSystem::release() { delete this; }
+
+} // graphics
+} // love
@@ -0,0 +1,126 @@
+/* WiiLÖVE ParticleSystem class
+ *
+ * This file is part of WiiLÖVE.
+ *
+ * Copyright (C) 2022  HTV04
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+// Libraries
+#include <grrlib-mod.h>
+#include <sol/sol.hpp>
+#include <cstdint>
+#include <utility>
+#include <tuple>
+#include <vector>
+
+// Classes
+#include "texture.hpp"
+
+namespace love {
+namespace graphics {
+
+// Particles are kept as one array per property, so updating them is a straight pass over contiguous floats.
+// Angles are in degrees, like the rest of the graphics module.
+class ParticleSystem {
+	private:
+		Texture texture;
+		std::vector<GRRLIB_texturePart> quads; // Picked by lifetime progress, the whole texture if empty
+
+		unsigned int maxParticles;
+		unsigned int count;
+
+		std::vector<float> positionX, positionY;
+		std::vector<float> velocityX, velocityY;
+		std::vector<float> accelerationX, accelerationY;
+		std::vector<float> progress, progressRate; // Lifetime progress from 0 to 1, and its change per second
+		std::vector<float> angle, spin;
+
+		float emitterX, emitterY;
+		float emissionRate, emitCounter;
+		float emitterLifetime, emitterLife; // A negative lifetime emits forever
+		bool active;
+
+		float direction, spread;
+		float speedMin, speedMax;
+		float lifetimeMin, lifetimeMax;
+		float accelerationXMin, accelerationYMin, accelerationXMax, accelerationYMax;
+		float spinMin, spinMax;
+		float rotationMin, rotationMax;
+
+		std::vector<float> colors; // RGBA 0-255, interpolated over lifetime
+		std::vector<float> sizes; // Interpolated over lifetime
+
+		uint32_t randomState;
+
+		float random(float min, float max);
+		void spawn();
+
+	public:
+		ParticleSystem(const Texture &texture, unsigned int maxParticles);
+
+		ParticleSystem(const ParticleSystem &other);
+
+		void emit(unsigned int amount);
+		void reset();
+		void start();
+		void stop();
+		void update(float dt);
+
+		unsigned int getBufferSize();
+		unsigned int getCount();
+		bool isActive();
+
+		std::tuple<float, float, float, float> getLinearAcceleration();
+		float getDirection();
+		float getEmissionRate();
+		float getEmitterLifetime();
+		std::pair<float, float> getParticleLifetime();
+		std::pair<float, float> getPosition();
+		std::pair<float, float> getRotation();
+		std::pair<float, float> getSpeed();
+		std::pair<float, float> getSpin();
+		float getSpread();
+		Texture getTexture();
+		void setColors(sol::variadic_args values);
+		void setDirection(float direction);
+		void setEmissionRate(float rate);
+		void setEmitterLifetime(float lifetime);
+		void setLinearAcceleration(float xMin, float yMin, float xMax, float yMax);
+		void setParticleLifetime(float min, float max);
+		void setParticleLifetime1(float lifetime);
+		void setPosition(float x, float y);
+		void setQuads(sol::variadic_args values);
+		void setRotation(float min, float max);
+		void setRotation1(float rotation);
+		void setSizes(sol::variadic_args values);
+		void setSpeed(float min, float max);
+		void setSpeed1(float speed);
+		void setSpin(float min, float max);
+		void setSpin1(float spin);
+		void setSpread(float spread);
+
+		void render(const Mtx matrix, unsigned int color) const; // Adds every particle to the sprite batch
+
+		ParticleSystem *clone();
+		void release();
+};
+
+} // graphics
+} // love
@@ -21,11 +21,29 @@
 
 // Libraries
 #include <grrlib-mod.h>
+#include <Metaphrasis.hpp>
+#include <ogc/lwp_watchdog.h>
+#include <png.h>
 #include <sol/sol.hpp>
+#include <malloc.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <csetjmp>
+#include <algorithm>
 #include <utility>
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+#include <stdexcept>
+
+// Classes
+#include "imagedata.hpp"
 
 // Modules
 #include "../../modules/filesystem.hpp"
+#include "../../modules/graphics.hpp"
 
 // Header
 #include "texture.hpp"
@@ -33,18 +51,796 @@
 namespace love {
 namespace graphics {
 
+// Lazy textures keep their file bytes and are only decoded once drawn, idle ones are dropped back to the bytes
+struct TextureResidency {
+	GRRLIB_texture *texture; // Data is nullptr while not resident
+	unsigned int size; // Bytes of the decoded data
+
+	std::string filename;
+	std::string format; // Resolved format name, never "auto"
+	bool mipmaps;
+
+	unsigned char *file; // nullptr once the pixels were edited, the texture then stays resident like an eager one
+	unsigned int fileSize;
+
+	unsigned int lastFrame;
+	unsigned long long lastUsed; // Ticks
+};
+
+// Local variables
+namespace {
+	using Converter = void (*)(uint32_t *, uint16_t, uint16_t, uint32_t *);
+
+	struct TextureFormat {
+		unsigned char format;
+		unsigned int tileWidth, tileHeight;
+		Converter convert; // Converts whole tile rows of RGBA values into an existing buffer
+	};
+
+	std::map<std::string, TextureFormat> formatMap = {
+		{"rgba8", {GX_TF_RGBA8, 4, 4, static_cast<Converter>(Metaphrasis::convertBufferToRGBA8)}},
+		{"rgb5a3", {GX_TF_RGB5A3, 4, 4, static_cast<Converter>(Metaphrasis::convertBufferToRGB5A3)}},
+		{"rgb565", {GX_TF_RGB565, 4, 4, static_cast<Converter>(Metaphrasis::convertBufferToRGB565)}},
+		{"ia8", {GX_TF_IA8, 4, 4, static_cast<Converter>(Metaphrasis::convertBufferToIA8)}},
+		{"ia4", {GX_TF_IA4, 8, 4, static_cast<Converter>(Metaphrasis::convertBufferToIA4)}},
+		{"i8", {GX_TF_I8, 8, 4, static_cast<Converter>(Metaphrasis::convertBufferToI8)}},
+		{"i4", {GX_TF_I4, 8, 8, static_cast<Converter>(Metaphrasis::convertBufferToI4)}},
+		{"cmpr", {GX_TF_CMPR, 8, 8, static_cast<Converter>(Metaphrasis::convertBufferToCMPR)}}
+	};
+
+	// Metaphrasis takes I4/I8 intensity from the lowest byte, use red instead of alpha
+	inline uint32_t toIntensity(uint32_t color, unsigned char format) {
+		return (format == GX_TF_I4 || format == GX_TF_I8) ? (color & 0xffffff00) | (color >> 24) : color;
+	}
+
+	bool isPowerOfTwo(unsigned int value) { return value != 0 && (value & (value - 1)) == 0; }
+
+	// Levels after the first down to 1x1, GX stops at LOD 10
+	unsigned char getMipmapLOD(unsigned int width, unsigned int height) {
+		unsigned char levels = 0;
+
+		for (unsigned int size = std::max(width, height); size > 1 && levels < 10; size >>= 1) levels++;
+
+		return levels;
+	}
+
+	// Converts one RGBA image into tiled data, padding partial tiles with the edge (small mip levels are smaller than a tile)
+	void convertLevel(const uint32_t *pixels, unsigned int width, unsigned int height, const TextureFormat &textureFormat, unsigned char *data) {
+		unsigned int tiledWidth = (width + textureFormat.tileWidth - 1) / textureFormat.tileWidth * textureFormat.tileWidth;
+		unsigned int tiledHeight = (height + textureFormat.tileHeight - 1) / textureFormat.tileHeight * textureFormat.tileHeight;
+		std::vector<uint32_t> tiled(tiledWidth * tiledHeight);
+
+		for (unsigned int y = 0; y < tiledHeight; y++) {
+			const uint32_t *row = pixels + std::min(y, height - 1) * width;
+
+			for (unsigned int x = 0; x < tiledWidth; x++) {
+				tiled[y * tiledWidth + x] = toIntensity(row[std::min(x, width - 1)], textureFormat.format);
+			}
+		}
+
+		textureFormat.convert(tiled.data(), tiledWidth, tiledHeight, reinterpret_cast<uint32_t *>(data));
+	}
+
+	// Converts the mip chain starting from the RGBA image of level 1, each level is box filtered from the one before
+	void convertMipmaps(const uint32_t *pixels, unsigned int width, unsigned int height, const TextureFormat &textureFormat, unsigned char maxLOD, unsigned char *data) {
+		std::vector<uint32_t> level(pixels, pixels + width * height), next;
+
+		for (unsigned char lod = 1; lod <= maxLOD; lod++) {
+			convertLevel(level.data(), width, height, textureFormat, data);
+			data += GX_GetTexBufferSize(width, height, textureFormat.format, GX_FALSE, 0);
+
+			if (lod == maxLOD) break;
+
+			next.resize(std::max(width / 2, 1u) * std::max(height / 2, 1u));
+			Metaphrasis::downsampleBuffer(level.data(), width, height, width, next.data());
+
+			level.swap(next);
+			width = std::max(width / 2, 1u);
+			height = std::max(height / 2, 1u);
+		}
+	}
+
+	// TPL containers hold pre-tiled GX data, they're big-endian like the Wii so headers are read in place
+	constexpr uint32_t tplMagic = 0x0020AF30;
+
+	struct TPLHeader {
+		uint32_t magic;
+		uint32_t imageCount;
+		uint32_t imageTableOffset;
+	};
+	struct TPLImageEntry {
+		uint32_t imageHeaderOffset;
+		uint32_t paletteHeaderOffset;
+	};
+	struct TPLImageHeader {
+		uint16_t height;
+		uint16_t width;
+		uint32_t format;
+		uint32_t dataOffset;
+		uint32_t wrapS, wrapT;
+		uint32_t minFilter, magFilter;
+		float lodBias;
+		uint8_t edgeLODEnable, minLOD, maxLOD, unpacked;
+	};
+
+	bool isTPL(const std::string &filename) {
+		return filename.size() >= 4 && filename.compare(filename.size() - 4, 4, ".tpl") == 0;
+	}
+
+	// Wraps already tiled data in a GRRLIB texture, which takes ownership of it
+	GRRLIB_texture *createTexture(unsigned int width, unsigned int height, void *data) {
+		GRRLIB_texture *texture = static_cast<GRRLIB_texture *>(std::calloc(1, sizeof(GRRLIB_texture)));
+
+		texture->width = width;
+		texture->height = height;
+		texture->data = data;
+		texture->part = {0.0f, 0.0f, static_cast<float>(width), static_cast<float>(height), width, height};
+
+		return texture;
+	}
+
+	// Reads the headers, then the texture data (with any mip levels) straight into its final buffer in one read
+	GRRLIB_texture *loadTPL(const char *filename, unsigned char &format, unsigned char &maxLOD) {
+		FILE *file = std::fopen(love::filesystem::getFilePath(filename).c_str(), "rb");
+		TPLHeader header;
+		TPLImageEntry entry;
+		TPLImageHeader image;
+
+		if (file == nullptr) { throw std::runtime_error("Could not load texture: " + std::string(filename)); }
+
+		bool valid = std::fread(&header, sizeof(header), 1, file) == 1 && header.magic == tplMagic && header.imageCount > 0 &&
+			std::fseek(file, header.imageTableOffset, SEEK_SET) == 0 && std::fread(&entry, sizeof(entry), 1, file) == 1 &&
+			std::fseek(file, entry.imageHeaderOffset, SEEK_SET) == 0 && std::fread(&image, sizeof(image), 1, file) == 1 &&
+			std::fseek(file, image.dataOffset, SEEK_SET) == 0;
+
+		if (!valid) {
+			std::fclose(file);
+
+			throw std::runtime_error("Invalid TPL file: " + std::string(filename));
+		}
+
+		bool mipmapped = image.maxLOD > 0;
+		unsigned int dataSize = GX_GetTexBufferSize(image.width, image.height, image.format, mipmapped, image.maxLOD + 1);
+		void *data = memalign(32, dataSize);
+
+		if (std::fread(data, 1, dataSize, file) != dataSize) {
+			std::fclose(file);
+			std::free(data);
+
+			throw std::runtime_error("Truncated TPL file: " + std::string(filename));
+		}
+
+		std::fclose(file);
+
+		DCFlushRange(data, dataSize);
+
+		format = image.format;
+		maxLOD = image.maxLOD;
+
+		return createTexture(image.width, image.height, data);
+	}
+
+	// Picks a format from a PNG's color type, since streaming can't look at the pixels first
+	const char *pickPNGFormat(int colorType, bool hasTransparency) {
+		switch (colorType) {
+			case PNG_COLOR_TYPE_GRAY:
+				return hasTransparency ? "ia8" : "i8";
+			case PNG_COLOR_TYPE_GRAY_ALPHA:
+				return "ia8";
+			case PNG_COLOR_TYPE_RGB:
+				return hasTransparency ? "rgb5a3" : "rgb565"; // tRNS only marks single colors fully transparent
+			case PNG_COLOR_TYPE_PALETTE:
+				return hasTransparency ? "rgba8" : "rgb565";
+			default:
+				return "rgba8";
+		}
+	}
+
+	// Decodes a PNG one tile row at a time, converting each band straight into the tiled texture data. Returns nullptr
+	// if the file isn't a PNG that can be streamed (interlaced images need every pass before any row is complete).
+	// Mipmaps are built from a quarter-size level 1 image filled band by band, so the full image is never held at once.
+	// The file is closed in every case.
+	GRRLIB_texture *loadPNG(FILE *file, const char *filename, const std::string &formatName, bool mipmaps, unsigned char &format, unsigned char &maxLOD) {
+		unsigned char signature[8];
+
+		if (std::fread(signature, 1, sizeof(signature), file) != sizeof(signature) || png_sig_cmp(signature, 0, sizeof(signature)) != 0) {
+			std::fclose(file);
+
+			return nullptr;
+		}
+
+		png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+		png_infop info = png_create_info_struct(png);
+		uint32_t *volatile band = nullptr;
+		uint32_t *volatile mipmap = nullptr;
+		void *volatile data = nullptr;
+
+		if (setjmp(png_jmpbuf(png))) { // libpng errors land here, nothing with a destructor may be alive past this point
+			png_destroy_read_struct(&png, &info, nullptr);
+			std::fclose(file);
+			std::free(band);
+			std::free(mipmap);
+			std::free(data);
+
+			throw std::runtime_error("Could not decode PNG: " + std::string(filename));
+		}
+
+		png_init_io(png, file);
+		png_set_sig_bytes(png, sizeof(signature));
+		png_read_info(png, info);
+
+		if (png_get_interlace_type(png, info) != PNG_INTERLACE_NONE) {
+			png_destroy_read_struct(&png, &info, nullptr);
+			std::fclose(file);
+
+			return nullptr;
+		}
+
+		unsigned int width = png_get_image_width(png, info);
+		unsigned int height = png_get_image_height(png, info);
+		int colorType = png_get_color_type(png, info);
+		bool hasTransparency = png_get_valid(png, info, PNG_INFO_tRNS) != 0;
+		auto target = formatMap.find(formatName == "auto" ? pickPNGFormat(colorType, hasTransparency) : formatName.c_str());
+
+		if (target == formatMap.end()) {
+			png_destroy_read_struct(&png, &info, nullptr);
+			std::fclose(file);
+
+			throw std::runtime_error("Invalid texture format: " + formatName);
+		}
+		if (mipmaps && (!isPowerOfTwo(width) || !isPowerOfTwo(height))) {
+			png_destroy_read_struct(&png, &info, nullptr);
+			std::fclose(file);
+
+			throw std::runtime_error("Mipmapped textures need power-of-two dimensions: " + std::string(filename));
+		}
+
+		// Every PNG is expanded to 8-bit RGBA rows, which on the big-endian Wii are already 0xRRGGBBAA values
+		png_set_expand(png);
+		png_set_strip_16(png);
+		png_set_gray_to_rgb(png);
+		png_set_filler(png, 0xff, PNG_FILLER_AFTER);
+		png_read_update_info(png, info);
+
+		const TextureFormat &textureFormat = target->second;
+		unsigned int tileHeight = textureFormat.tileHeight;
+		unsigned int tiledWidth = (width + textureFormat.tileWidth - 1) / textureFormat.tileWidth * textureFormat.tileWidth;
+		unsigned int tiledHeight = (height + tileHeight - 1) / tileHeight * tileHeight;
+		unsigned int levelSize = GX_GetTexBufferSize(width, height, textureFormat.format, GX_FALSE, 0);
+		unsigned int bandSize = levelSize / (tiledHeight / tileHeight);
+		unsigned int mipmapWidth = std::max(width / 2, 1u), mipmapHeight = std::max(height / 2, 1u);
+
+		maxLOD = mipmaps ? getMipmapLOD(width, height) : 0;
+
+		unsigned int dataSize = maxLOD > 0 ? GX_GetTexBufferSize(width, height, textureFormat.format, GX_TRUE, maxLOD + 1) : levelSize;
+
+		data = memalign(32, dataSize);
+		band = static_cast<uint32_t *>(std::malloc(tiledWidth * tileHeight * sizeof(uint32_t)));
+		if (maxLOD > 0) mipmap = static_cast<uint32_t *>(std::malloc(mipmapWidth * mipmapHeight * sizeof(uint32_t)));
+
+		if (data == nullptr || band == nullptr || (maxLOD > 0 && mipmap == nullptr)) png_error(png, "Out of memory");
+
+		for (unsigned int y = 0; y < tiledHeight; y++) {
+			uint32_t *row = band + (y % tileHeight) * tiledWidth;
+
+			if (y < height) {
+				png_read_row(png, reinterpret_cast<png_bytep>(row), nullptr);
+
+				for (unsigned int x = width; x < tiledWidth; x++) row[x] = row[width - 1]; // Pad partial tiles with the edge
+			} else {
+				std::memcpy(row, band + ((height - 1) % tileHeight) * tiledWidth, tiledWidth * sizeof(uint32_t));
+			}
+
+			if (y % tileHeight == tileHeight - 1) {
+				if (maxLOD > 0) { // Power-of-two heights below a tile only have one band, with fewer real rows
+					Metaphrasis::downsampleBuffer(band, width, std::min(tileHeight, height), tiledWidth, mipmap + (y / tileHeight) * (tileHeight / 2) * mipmapWidth);
+				}
+				if (textureFormat.format == GX_TF_I4 || textureFormat.format == GX_TF_I8) {
+					for (unsigned int i = 0; i < tiledWidth * tileHeight; i++) band[i] = toIntensity(band[i], textureFormat.format);
+				}
+
+				textureFormat.convert(band, tiledWidth, tileHeight, reinterpret_cast<uint32_t *>(static_cast<unsigned char *>(data) + (y / tileHeight) * bandSize));
+			}
+		}
+
+		png_read_end(png, nullptr);
+		png_destroy_read_struct(&png, &info, nullptr);
+		std::fclose(file);
+		std::free(band);
+
+		if (maxLOD > 0) {
+			convertMipmaps(mipmap, mipmapWidth, mipmapHeight, textureFormat, maxLOD, static_cast<unsigned char *>(data) + levelSize);
+			std::free(mipmap);
+		}
+
+		DCFlushRange(data, dataSize);
+
+		format = textureFormat.format;
+
+		return createTexture(width, height, data);
+	}
+
+	bool fitsFormat(const GRRLIB_texture *texture, const std::string &format) {
+		const TextureFormat &info = formatMap.at(format);
+
+		return texture->width % info.tileWidth == 0 && texture->height % info.tileHeight == 0;
+	}
+
+	// Picks the cheapest format that keeps the texture's alpha and color content
+	std::string pickFormat(const GRRLIB_texture *texture) {
+		bool grayscale = true, opaque = true, binaryAlpha = true;
+
+		for (unsigned int y = 0; y < texture->height; y++) {
+			for (unsigned int x = 0; x < texture->width; x++) {
+				unsigned int color = GRRLIB_GetPixelFromtexImg(x, y, texture);
+				unsigned char alpha = GRRLIB_A(color);
+
+				if (GRRLIB_R(color) != GRRLIB_G(color) || GRRLIB_G(color) != GRRLIB_B(color)) grayscale = false;
+				if (alpha != 255) opaque = false;
+				if (alpha != 0 && alpha != 255) binaryAlpha = false;
+			}
+		}
+
+		const char *candidates[2];
+
+		if (grayscale) {
+			candidates[0] = opaque ? "i8" : "ia8";
+			candidates[1] = opaque ? "ia8" : "rgba8";
+		} else {
+			candidates[0] = opaque ? "rgb565" : (binaryAlpha ? "rgb5a3" : "rgba8");
+			candidates[1] = "rgba8";
+		}
+
+		return fitsFormat(texture, candidates[0]) ? candidates[0] : candidates[1];
+	}
+	// Converts an RGBA8 texture decoded whole by GRRLIB (JPEG, interlaced PNG) into its final format
+	GRRLIB_texture *convertTexture(GRRLIB_texture *texture, const char *filename, const std::string &format, bool mipmaps, unsigned char &textureFormat, unsigned char &maxLOD) {
+		std::string formatName = format == "auto" ? pickFormat(texture) : format;
+
+		if (formatMap.count(formatName) == 0 || !fitsFormat(texture, formatName)) {
+			GRRLIB_FreeTexture(texture);
+
+			if (formatMap.count(formatName) == 0) { throw std::runtime_error("Invalid texture format: " + formatName); }
+			throw std::runtime_error("Texture dimensions don't fit format: " + formatName);
+		}
+		if (mipmaps && (!isPowerOfTwo(texture->width) || !isPowerOfTwo(texture->height))) {
+			GRRLIB_FreeTexture(texture);
+
+			throw std::runtime_error("Mipmapped textures need power-of-two dimensions: " + std::string(filename));
+		}
+
+		const TextureFormat &info = formatMap.at(formatName); // Never inserts, so it is safe on the loader thread
+
+		maxLOD = mipmaps ? getMipmapLOD(texture->width, texture->height) : 0;
+
+		if (info.format != GX_TF_RGBA8 || maxLOD > 0) { // GRRLIB loads RGBA8, so go through a linear RGBA buffer
+			std::vector<uint32_t> pixels(texture->width * texture->height);
+			unsigned int levelSize = GX_GetTexBufferSize(texture->width, texture->height, info.format, GX_FALSE, 0);
+			unsigned int dataSize = GX_GetTexBufferSize(texture->width, texture->height, info.format, maxLOD > 0, maxLOD + 1);
+
+			for (unsigned int y = 0; y < texture->height; y++) {
+				for (unsigned int x = 0; x < texture->width; x++) {
+					pixels[y * texture->width + x] = GRRLIB_GetPixelFromtexImg(x, y, texture);
+				}
+			}
+
+			free(texture->data);
+			texture->data = memalign(32, dataSize);
+			convertLevel(pixels.data(), texture->width, texture->height, info, static_cast<unsigned char *>(texture->data));
+
+			if (maxLOD > 0) {
+				std::vector<uint32_t> mipmap(std::max(texture->width / 2, 1u) * std::max(texture->height / 2, 1u));
+
+				Metaphrasis::downsampleBuffer(pixels.data(), texture->width, texture->height, texture->width, mipmap.data());
+				convertMipmaps(mipmap.data(), std::max(texture->width / 2, 1u), std::max(texture->height / 2, 1u), info, maxLOD, static_cast<unsigned char *>(texture->data) + levelSize);
+			}
+
+			DCFlushRange(texture->data, dataSize);
+		}
+
+		textureFormat = info.format;
+
+		return texture;
+	}
+
+	// Loads a texture from any supported file into its final format
+	GRRLIB_texture *loadTexture(const char *filename, const std::string &format, bool mipmaps, unsigned char &textureFormat, unsigned char &maxLOD) {
+		if (isTPL(filename)) return loadTPL(filename, textureFormat, maxLOD); // Already in its final format, no decoding or conversion
+
+		FILE *file = std::fopen(love::filesystem::getFilePath(filename).c_str(), "rb");
+
+		if (file == nullptr) { throw std::runtime_error("Could not load texture: " + std::string(filename)); }
+
+		GRRLIB_texture *texture = loadPNG(file, filename, format, mipmaps, textureFormat, maxLOD);
+
+		if (texture != nullptr) return texture;
+
+		texture = GRRLIB_LoadTextureFromFile(love::filesystem::getFilePath(filename).c_str());
+
+		if (texture == nullptr) { throw std::runtime_error("Could not load texture: " + std::string(filename)); }
+
+		return convertTexture(texture, filename, format, mipmaps, textureFormat, maxLOD);
+	}
+
+	// Same as loadTexture, but from file bytes already in memory
+	GRRLIB_texture *decodeTexture(unsigned char *bytes, unsigned int size, const char *filename, const std::string &format, bool mipmaps, unsigned char &textureFormat, unsigned char &maxLOD) {
+		FILE *file = fmemopen(bytes, size, "rb");
+
+		if (file == nullptr) { throw std::runtime_error("Could not decode texture: " + std::string(filename)); }
+
+		GRRLIB_texture *texture = loadPNG(file, filename, format, mipmaps, textureFormat, maxLOD);
+
+		if (texture != nullptr) return texture;
+
+		texture = GRRLIB_LoadTexture(bytes);
+
+		if (texture == nullptr) { throw std::runtime_error("Could not decode texture: " + std::string(filename)); }
+
+		return convertTexture(texture, filename, format, mipmaps, textureFormat, maxLOD);
+	}
+
+	inline unsigned int readBE16(const unsigned char *bytes) { return (bytes[0] << 8) | bytes[1]; }
+	inline uint32_t readBE32(const unsigned char *bytes) {
+		return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) | (static_cast<uint32_t>(bytes[2]) << 8) | bytes[3];
+	}
+
+	// Reads the dimensions of a PNG or JPEG without decoding it, along with the format "auto" picks and whether it can
+	// be streamed. Lazy textures need all of this before their first decode.
+	bool readImageHeader(const unsigned char *bytes, unsigned int size, unsigned int &width, unsigned int &height, const char *&autoFormat, bool &streamable) {
+		if (size >= 33 && png_sig_cmp(bytes, 0, 8) == 0) {
+			bool hasTransparency = false;
+
+			for (unsigned int offset = 8; offset + 8 <= size;) { // Chunks before the image data
+				uint32_t length = readBE32(bytes + offset);
+
+				if (std::memcmp(bytes + offset + 4, "IDAT", 4) == 0) break;
+				if (std::memcmp(bytes + offset + 4, "tRNS", 4) == 0) hasTransparency = true;
+
+				if (size - offset < 12 || length > size - offset - 12) return false; // Runs past the file, corrupt
+
+				offset += length + 12;
+			}
+
+			width = readBE32(bytes + 16);
+			height = readBE32(bytes + 20);
+			autoFormat = pickPNGFormat(bytes[25], hasTransparency);
+			streamable = bytes[28] == PNG_INTERLACE_NONE;
+
+			return true;
+		}
+
+		if (size >= 4 && bytes[0] == 0xff && bytes[1] == 0xd8) { // JPEG, the size is in the start of frame segment
+			for (unsigned int offset = 2; offset + 9 <= size && bytes[offset] == 0xff;) {
+				unsigned char marker = bytes[offset + 1];
+
+				if (marker >= 0xc0 && marker <= 0xcf && marker != 0xc4 && marker != 0xc8 && marker != 0xcc) {
+					height = readBE16(bytes + offset + 5);
+					width = readBE16(bytes + offset + 7);
+					autoFormat = "rgb565"; // JPEGs have no alpha
+					streamable = false;
+
+					return true;
+				}
+
+				offset += marker == 0xff ? 1 : readBE16(bytes + offset + 2) + 2; // 0xff is fill before a marker
+			}
+		}
+
+		return false;
+	}
+
+	// Textures loaded from files, shared by resolved path and settings. Entries only referenced by the cache stay
+	// resident until the bytes held go over the budget, then the least recently loaded ones are freed first.
+	struct CachedTexture {
+		std::string key;
+		Texture *texture; // The cache's own reference
+	};
+
+	std::list<CachedTexture> textureCache; // Most recently used first
+	std::map<std::string, std::list<CachedTexture>::iterator> textureCacheIndex;
+	unsigned int textureCacheBudget = 8 * 1024 * 1024;
+	unsigned int textureCacheMemory = 0;
+	unsigned int textureEvictions = 0;
+
+	std::string getCacheKey(const char *filename, const std::string &format, bool mipmaps, bool lazy) {
+		return love::filesystem::getFilePath(filename) + ":" + format + (mipmaps ? ":mipmaps" : "") + (lazy ? ":lazy" : "");
+	}
+
+	void evictTextures() {
+		for (auto entry = textureCache.end(); entry != textureCache.begin() && textureCacheMemory > textureCacheBudget;) {
+			--entry;
+
+			if (entry->texture->getReferenceCount() > 1) continue; // Still used by scripts
+
+			textureCacheMemory -= entry->texture->size;
+			textureEvictions++;
+
+			delete entry->texture;
+			textureCacheIndex.erase(entry->key);
+			entry = textureCache.erase(entry);
+		}
+	}
+
+	std::vector<TextureResidency *> lazyTextures;
+	unsigned int residencyIdleTime = 30000; // Milliseconds
+	unsigned int residencyBudget = 8 * 1024 * 1024;
+	unsigned int residencyFrame = 0;
+	unsigned int lazyTextureMemory = 0; // Decoded bytes of resident lazy textures
+	unsigned int compressedTextureMemory = 0; // File bytes kept by lazy textures
+	unsigned int textureDecodes = 0;
+	unsigned int textureUnloads = 0;
+
+	// Reads the file and header of a lazy texture, everything but the pixels is known from then on
+	TextureResidency *createResidency(const char *filename, const std::string &format, bool mipmaps, unsigned char &textureFormat, unsigned char &maxLOD) {
+		void *file = nullptr;
+		int fileSize = 0;
+		unsigned int width, height;
+		const char *autoFormat;
+		bool streamable;
+
+		love::filesystem::getFileData(filename, file, fileSize);
+
+		if (!readImageHeader(static_cast<unsigned char *>(file), fileSize, width, height, autoFormat, streamable)) {
+			std::free(file);
+
+			throw std::runtime_error("Unsupported lazy texture: " + std::string(filename));
+		}
+
+		std::string formatName = format == "auto" ? autoFormat : format;
+		auto target = formatMap.find(formatName);
+
+		if (target == formatMap.end()) {
+			std::free(file);
+
+			throw std::runtime_error("Invalid texture format: " + formatName);
+		}
+		if (!streamable && (width % target->second.tileWidth != 0 || height % target->second.tileHeight != 0)) { // Same rule as eager loads
+			std::free(file);
+
+			throw std::runtime_error("Texture dimensions don't fit format: " + formatName);
+		}
+		if (mipmaps && (!isPowerOfTwo(width) || !isPowerOfTwo(height))) {
+			std::free(file);
+
+			throw std::runtime_error("Mipmapped textures need power-of-two dimensions: " + std::string(filename));
+		}
+
+		textureFormat = target->second.format;
+		maxLOD = mipmaps ? getMipmapLOD(width, height) : 0;
+
+		TextureResidency *residency = new TextureResidency();
+
+		residency->texture = createTexture(width, height, nullptr);
+		residency->size = GX_GetTexBufferSize(width, height, textureFormat, maxLOD > 0, maxLOD + 1);
+		residency->filename = filename;
+		residency->format = formatName;
+		residency->mipmaps = mipmaps;
+		residency->file = static_cast<unsigned char *>(file);
+		residency->fileSize = fileSize;
+		residency->lastFrame = residencyFrame;
+		residency->lastUsed = gettime();
+
+		lazyTextures.push_back(residency);
+		compressedTextureMemory += fileSize;
+
+		return residency;
+	}
+
+	void unloadTexture(TextureResidency *residency) {
+		std::free(residency->texture->data);
+		residency->texture->data = nullptr;
+
+		love::graphics::trackTextureMemory(-static_cast<int>(residency->size));
+		lazyTextureMemory -= residency->size;
+		textureUnloads++;
+	}
+}
+
+// Texture formats
+bool getTextureFormat(const std::string &name, unsigned char &format) {
+	auto entry = formatMap.find(name);
+
+	if (entry == formatMap.end()) return false;
+
+	format = entry->second.format;
+
+	return true;
+}
+std::string getTextureFormatName(unsigned char format) {
+	for (const std::pair<const std::string, TextureFormat> &entry : formatMap) {
+		if (entry.second.format == format) return entry.first;
+	}
+
+	return "unknown";
+}
+
+// Texture cache
+unsigned int getTextureCacheBudget() { return textureCacheBudget; }
+void setTextureCacheBudget(unsigned int bytes) {
+	textureCacheBudget = bytes;
+
+	evictTextures();
+}
+unsigned int getTextureCacheMemory() { return textureCacheMemory; }
+unsigned int getTextureEvictions() { return textureEvictions; }
+
+bool isTextureCached(const char *filename, const std::string &format, bool mipmaps) {
+	return textureCacheIndex.count(getCacheKey(filename, format, mipmaps, false)) > 0;
+}
+
+// Lazy texture residency
+std::pair<double, unsigned int> getTextureResidency() {
+	return std::make_pair(residencyIdleTime / 1000.0, residencyBudget);
+}
+void setTextureResidency(double idleTime, unsigned int budget) {
+	residencyIdleTime = idleTime * 1000.0;
+	residencyBudget = budget;
+}
+unsigned int getLazyTextureMemory() { return lazyTextureMemory; }
+unsigned int getCompressedTextureMemory() { return compressedTextureMemory; }
+unsigned int getTextureDecodes() { return textureDecodes; }
+unsigned int getTextureUnloads() { return textureUnloads; }
+
+// Drops lazy textures idle for too long, then the least recently drawn ones while over budget. Called on present;
+// textures drawn in that frame are kept, and GX is done with every earlier frame.
+void updateTextureResidency() {
+	unsigned long long now = gettime();
+	std::vector<TextureResidency *> idle;
+
+	for (TextureResidency *residency : lazyTextures) {
+		if (residency->texture->data == nullptr || residency->lastFrame == residencyFrame) continue;
+
+		if (diff_msec(residency->lastUsed, now) > residencyIdleTime)
+			unloadTexture(residency);
+		else
+			idle.push_back(residency);
+	}
+
+	if (lazyTextureMemory > residencyBudget) {
+		std::sort(idle.begin(), idle.end(), [](const TextureResidency *a, const TextureResidency *b) { return a->lastUsed < b->lastUsed; });
+
+		for (auto residency = idle.begin(); residency != idle.end() && lazyTextureMemory > residencyBudget; ++residency) unloadTexture(*residency);
+	}
+
+	residencyFrame++;
+}
+
+// Texture loading, only touches the loaded data so it can run on a worker thread
+LoadedTexture loadTextureFile(const char *filename, const std::string &format, bool mipmaps) {
+	LoadedTexture loaded;
+
+	loaded.key = getCacheKey(filename, format, mipmaps, false);
+	loaded.texture = loadTexture(filename, format, mipmaps, loaded.format, loaded.maxLOD);
+
+	return loaded;
+}
+
 // Constructor
-Texture::Texture(const char *filename) {
+Texture::Texture(const char *filename) : Texture(filename, "rgba8") {}
+Texture::Texture(const char *filename, const std::string &format) : Texture(filename, format, false) {}
+Texture::Texture(const char *filename, const std::string &format, bool mipmaps) : Texture(filename, format, mipmaps, false) {}
+Texture::Texture(const char *filename, const std::string &format, bool mipmaps, bool lazy) {
+	lazy = lazy && !isTPL(filename); // TPL data is already final, keeping it around compressed gains nothing
+
+	std::string key = getCacheKey(filename, format, mipmaps, lazy);
+
+	if (share(key)) return;
+
+	if (!lazy) {
+		adopt(loadTextureFile(filename, format, mipmaps));
+
+		return;
+	}
+
+	residency = createResidency(filename, format, mipmaps, this->format, maxLOD);
+	texture = residency->texture;
+	size = residency->size;
+
+	instances = new int(1);
+
+	cache(key);
+}
+Texture::Texture(const LoadedTexture &loaded) {
+	if (share(loaded.key)) { // Loaded again while it was in flight, keep the first copy
+		GRRLIB_FreeTexture(loaded.texture);
+
+		return;
+	}
+
+	adopt(loaded);
+}
+Texture::Texture(GRRLIB_texture *texture) : texture(texture) { // Takes ownership of an existing RGBA8 texture
 	instances = new int(1);
+	residency = nullptr;
+
+	format = GX_TF_RGBA8;
+	maxLOD = 0;
+	size = GX_GetTexBufferSize(texture->width, texture->height, format, GX_FALSE, 0);
+	love::graphics::trackTextureMemory(size);
+}
+
+Texture::Texture(const ImageData &imageData) {
+	void *data = memalign(32, imageData.size);
+
+	std::memcpy(data, imageData.data, imageData.size);
+	DCFlushRange(data, imageData.size);
+
+	texture = createTexture(imageData.width, imageData.height, data);
+
+	instances = new int(1);
+	residency = nullptr;
+
+	format = imageData.format;
+	maxLOD = 0;
+	size = imageData.size;
+	love::graphics::trackTextureMemory(size);
+}
+
+// Cache handling
+bool Texture::share(const std::string &key) { // Shares a cached texture like a clone
+	auto cached = textureCacheIndex.find(key);
+
+	if (cached == textureCacheIndex.end()) return false;
+
+	const Texture &other = *cached->second->texture;
+
+	instances = other.instances;
+	residency = other.residency;
+
+	texture = other.texture;
+	format = other.format;
+	maxLOD = other.maxLOD;
+	size = other.size;
+
+	(*instances)++;
+
+	textureCache.splice(textureCache.begin(), textureCache, cached->second);
+
+	return true;
+}
+void Texture::adopt(const LoadedTexture &loaded) { // Takes ownership of loaded data and caches it
+	texture = loaded.texture;
+	format = loaded.format;
+	maxLOD = loaded.maxLOD;
+
+	instances = new int(1);
+	residency = nullptr;
+
+	size = GX_GetTexBufferSize(texture->width, texture->height, format, maxLOD > 0, maxLOD + 1);
+	love::graphics::trackTextureMemory(size);
 
-	texture = GRRLIB_LoadTextureFromFile(love::filesystem::getFilePath(filename).c_str());
+	cache(loaded.key);
+}
+void Texture::cache(const std::string &key) { // Gives the cache its own reference
+	textureCache.push_front({key, new Texture(*this)});
+	textureCacheIndex[key] = textureCache.begin();
+	textureCacheMemory += size;
+
+	evictTextures();
+}
+void Texture::uncache() { // Drops the cache's reference, so later loads of the file get the file's pixels again
+	for (auto entry = textureCache.begin(); entry != textureCache.end(); ++entry) {
+		if (entry->texture->instances != instances) continue;
+
+		textureCacheMemory -= size;
+
+		delete entry->texture;
+		textureCacheIndex.erase(entry->key);
+		textureCache.erase(entry);
+
+		return;
+	}
 }
 
 // Clone constructor
 Texture::Texture(const Texture &other) {
 	instances = other.instances;
+	residency = other.residency;
 
 	texture = other.texture;
+	format = other.format;
+	maxLOD = other.maxLOD;
+	size = other.size;
 
 	(*instances)++;
 }
@@ -55,6 +851,68 @@ unsigned int Texture::getHeight() { return texture->height; }
 std::pair<unsigned int, unsigned int> Texture::getDimensions() {
 	return std::make_pair(texture->width, texture->height);
 }
+std::string Texture::getFormat() { return getTextureFormatName(format); }
+int Texture::getReferenceCount() const { return *instances; }
+
+// Residency
+void Texture::makeResident() const { // Decodes a lazy texture's file bytes if they were never decoded or were dropped
+	if (residency == nullptr) return;
+
+	residency->lastFrame = residencyFrame;
+	residency->lastUsed = gettime();
+
+	if (texture->data != nullptr) return;
+
+	unsigned char decodedFormat, decodedLOD;
+	GRRLIB_texture *decoded = decodeTexture(residency->file, residency->fileSize, residency->filename.c_str(), residency->format, residency->mipmaps, decodedFormat, decodedLOD);
+
+	texture->data = decoded->data;
+	decoded->data = nullptr;
+	GRRLIB_FreeTexture(decoded);
+
+	love::graphics::trackTextureMemory(residency->size);
+	lazyTextureMemory += residency->size;
+	textureDecodes++;
+}
+
+// Pixel replacement, copies whole tile rows of the region and only flushes those
+void Texture::replacePixels(const ImageData &imageData) {
+	replacePixels(imageData, 0, 0, imageData.width, imageData.height);
+}
+void Texture::replacePixels(const ImageData &imageData, unsigned int x, unsigned int y, unsigned int width, unsigned int height) {
+	if (imageData.format != format || imageData.width != texture->width || imageData.height != texture->height || maxLOD > 0) {
+		throw std::runtime_error("ImageData doesn't match the texture's format and dimensions");
+	}
+	if (width == 0 || height == 0) return;
+	if (x + width > imageData.width || y + height > imageData.height) { throw std::runtime_error("Pixel region out of bounds"); }
+
+	love::graphics::flushBatch(); // Quads batched so far were meant to use the old pixels
+
+	makeResident();
+	uncache(); // The edited pixels no longer match the file
+
+	if (residency != nullptr && residency->file != nullptr) { // Unloading would re-decode the file and lose the edits
+		lazyTextures.erase(std::find(lazyTextures.begin(), lazyTextures.end(), residency));
+		lazyTextureMemory -= size;
+		compressedTextureMemory -= residency->fileSize;
+
+		std::free(residency->file);
+		residency->file = nullptr;
+		residency->fileSize = 0;
+	}
+
+	unsigned char *data = static_cast<unsigned char *>(texture->data);
+
+	for (unsigned int tileY = y - y % imageData.tileHeight; tileY < y + height; tileY += imageData.tileHeight) {
+		unsigned int start = imageData.getTileOffset(x, tileY);
+		unsigned int end = imageData.getTileOffset(x + width - 1, tileY) + imageData.tileSize;
+
+		std::memcpy(data + start, imageData.data + start, end - start);
+		DCFlushRange(data + start, end - start);
+	}
+
+	GX_InvalidateTexAll(); // GX can't invalidate part of its texture cache
+}
 
 // Object functions
 Texture *Texture::clone() {
@@ -65,6 +923,26 @@ void Texture::release() { delete this; }
 // Destructor
 Texture::~Texture() {
 	if (--(*instances) == 0) {
+		love::graphics::flushBatch(); // Pending quads may still use this texture
+		love::graphics::waitForFrame(); // So may the previous frame, with asynchronous presents
+
+		if (residency != nullptr && residency->file != nullptr) {
+			if (texture->data != nullptr) {
+				love::graphics::trackTextureMemory(-static_cast<int>(size));
+				lazyTextureMemory -= size;
+			}
+
+			lazyTextures.erase(std::find(lazyTextures.begin(), lazyTextures.end(), residency));
+			compressedTextureMemory -= residency->fileSize;
+
+			std::free(residency->file);
+			delete residency;
+		} else {
+			love::graphics::trackTextureMemory(-static_cast<int>(size));
+
+			delete residency; // Left over from a lazy texture that was edited, if any
+		}
+
 		GRRLIB_FreeTexture(texture);
 
 		delete instances;
@@ -23,24 +23,77 @@
 
 #include <grrlib-mod.h>
 #include <utility>
+#include <string>
 
 namespace love {
 namespace graphics {
 
+class ImageData;
+struct TextureResidency;
+
+bool getTextureFormat(const std::string &name, unsigned char &format);
+std::string getTextureFormatName(unsigned char format);
+
+// A texture decoded into its final format, not yet tracked or cached
+struct LoadedTexture {
+	std::string key;
+	GRRLIB_texture *texture;
+	unsigned char format;
+	unsigned char maxLOD;
+};
+
+LoadedTexture loadTextureFile(const char *filename, const std::string &format, bool mipmaps);
+
+bool isTextureCached(const char *filename, const std::string &format, bool mipmaps);
+unsigned int getTextureCacheBudget();
+void setTextureCacheBudget(unsigned int bytes);
+unsigned int getTextureCacheMemory();
+unsigned int getTextureEvictions();
+
+std::pair<double, unsigned int> getTextureResidency();
+void setTextureResidency(double idleTime, unsigned int budget);
+unsigned int getLazyTextureMemory();
+unsigned int getCompressedTextureMemory();
+unsigned int getTextureDecodes();
+unsigned int getTextureUnloads();
+void updateTextureResidency();
+
 class Texture {
 	private:
 		int *instances;
+		TextureResidency *residency; // Shared by clones, nullptr unless the texture is lazy
+
+		bool share(const std::string &key);
+		void adopt(const LoadedTexture &loaded);
+		void cache(const std::string &key);
+		void uncache();
 
 	public:
 		GRRLIB_texture *texture;
+		unsigned char format; // GX texture format of the data
+		unsigned char maxLOD; // Number of mip levels after the first
+		unsigned int size; // Bytes used by the data
 
 		Texture(const char *filename);
+		Texture(const char *filename, const std::string &format);
+		Texture(const char *filename, const std::string &format, bool mipmaps);
+		Texture(const char *filename, const std::string &format, bool mipmaps, bool lazy);
+		Texture(const LoadedTexture &loaded);
+		Texture(GRRLIB_texture *texture);
+		Texture(const ImageData &imageData);
 
 		Texture(const Texture &other);
 
 		unsigned int getWidth();
 		unsigned int getHeight();
 		std::pair<unsigned int, unsigned int> getDimensions();
+		std::string getFormat();
+		int getReferenceCount() const; // Handles sharing the texture data, including the cache's
+
+		void makeResident() const;
+
+		void replacePixels(const ImageData &imageData);
+		void replacePixels(const ImageData &imageData, unsigned int x, unsigned int y, unsigned int width, unsigned int height);
 
 		Texture *clone();
 		void release();
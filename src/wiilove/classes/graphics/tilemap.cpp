@@ -0,0 +1,269 @@
+/* WiiLÖVE TileMap class
+ *
+ * This file is part of WiiLÖVE.
+ *
+ * Copyright (C) 2022  HTV04
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+
+// Libraries
+#include <grrlib-mod.h>
+#include <malloc.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include <stdexcept>
+
+// Classes
+#include "texture.hpp"
+
+// Modules
+#include "../../modules/graphics.hpp"
+
+// Header
+#include "tilemap.hpp"
+
+namespace love {
+namespace graphics {
+
+// Local variables
+namespace {
+	constexpr unsigned int cornersPerRow = TileMap::chunkSize + 1;
+	constexpr unsigned int bytesPerVertex = 5; // u16 position index, u8 color index, u16 texture coordinate index
+
+	// Display lists hold raw FIFO commands: a draw command, a big-endian vertex count, then the vertex indices
+	inline unsigned char *writeU16(unsigned char *out, unsigned int value) {
+		out[0] = value >> 8;
+		out[1] = value & 0xff;
+
+		return out + 2;
+	}
+}
+
+// Constructor
+TileMap::TileMap(const Texture &texture, unsigned int tileWidth, unsigned int tileHeight, unsigned int columns, unsigned int rows) :
+	tileWidth(tileWidth), tileHeight(tileHeight), columns(columns), rows(rows), texture(texture) {
+	if (tileWidth == 0 || tileHeight == 0 || tileWidth * chunkSize > 32767 || tileHeight * chunkSize > 32767) { throw std::runtime_error("Invalid tile size"); }
+	if (columns == 0 || rows == 0) { throw std::runtime_error("Invalid tile map size"); }
+
+	atlasColumns = texture.texture->width / tileWidth;
+	atlasTiles = atlasColumns * (texture.texture->height / tileHeight);
+
+	if (atlasTiles == 0 || atlasTiles > 16383) { throw std::runtime_error("Texture doesn't fit the tile size"); } // Four 16-bit indices per tile
+
+	tiles.assign(columns * rows, 0);
+	remap.resize(atlasTiles + 1);
+	for (unsigned int i = 0; i <= atlasTiles; i++) remap[i] = i;
+
+	init();
+}
+
+// Clone constructor
+TileMap::TileMap(const TileMap &other) :
+	tileWidth(other.tileWidth), tileHeight(other.tileHeight), columns(other.columns), rows(other.rows),
+	atlasColumns(other.atlasColumns), atlasTiles(other.atlasTiles), tiles(other.tiles), remap(other.remap), texture(other.texture) {
+	init();
+}
+
+// Allocates the arrays and empty chunks, the GPU reads all of them so they're 32-byte aligned
+void TileMap::init() {
+	chunkColumns = (columns + chunkSize - 1) / chunkSize;
+	chunkRows = (rows + chunkSize - 1) / chunkSize;
+	chunks.assign(chunkColumns * chunkRows, {nullptr, 0, true});
+
+	positions = static_cast<short *>(memalign(32, cornersPerRow * cornersPerRow * 2 * sizeof(short)));
+	texCoords = nullptr; // Allocated by updateTexCoords before the first draw
+
+	for (unsigned int y = 0; y < cornersPerRow; y++) {
+		for (unsigned int x = 0; x < cornersPerRow; x++) {
+			positions[(y * cornersPerRow + x) * 2] = x * tileWidth;
+			positions[(y * cornersPerRow + x) * 2 + 1] = y * tileHeight;
+		}
+	}
+
+	DCFlushRange(positions, cornersPerRow * cornersPerRow * 2 * sizeof(short));
+
+	texCoordsDirty = true;
+}
+
+// TileMap properties
+std::pair<unsigned int, unsigned int> TileMap::getDimensions() {
+	return std::make_pair(columns, rows);
+}
+std::pair<unsigned int, unsigned int> TileMap::getTileDimensions() {
+	return std::make_pair(tileWidth, tileHeight);
+}
+unsigned int TileMap::getTile(unsigned int x, unsigned int y) {
+	if (x >= columns || y >= rows) { throw std::runtime_error("Tile position out of bounds"); }
+
+	return tiles[y * columns + x];
+}
+unsigned int TileMap::getTileRemap(unsigned int tile) {
+	if (tile == 0 || tile > atlasTiles) { throw std::runtime_error("Invalid tile index"); }
+
+	return remap[tile];
+}
+void TileMap::setTile(unsigned int x, unsigned int y, unsigned int tile) {
+	if (x >= columns || y >= rows) { throw std::runtime_error("Tile position out of bounds"); }
+	if (tile > atlasTiles) { throw std::runtime_error("Invalid tile index"); }
+
+	if (tiles[y * columns + x] == tile) return;
+
+	tiles[y * columns + x] = tile;
+	chunks[(y / chunkSize) * chunkColumns + x / chunkSize].dirty = true;
+}
+void TileMap::setTileRemap(unsigned int tile, unsigned int target) { // Only the texture coordinate array changes, no chunk is rebuilt
+	if (tile == 0 || tile > atlasTiles || target == 0 || target > atlasTiles) { throw std::runtime_error("Invalid tile index"); }
+
+	if (remap[tile] == target) return;
+
+	remap[tile] = target;
+	texCoordsDirty = true;
+}
+
+// Display lists
+void TileMap::buildChunk(unsigned int chunkX, unsigned int chunkY) {
+	Chunk &chunk = chunks[chunkY * chunkColumns + chunkX];
+	unsigned int endX = std::min((chunkX + 1) * chunkSize, columns), endY = std::min((chunkY + 1) * chunkSize, rows);
+	unsigned int tileCount = 0;
+
+	for (unsigned int y = chunkY * chunkSize; y < endY; y++) {
+		for (unsigned int x = chunkX * chunkSize; x < endX; x++) {
+			if (tiles[y * columns + x] != 0) tileCount++;
+		}
+	}
+
+	love::graphics::releaseAfterFrame(chunk.displayList); // Earlier draws, in this frame or one still drawing, may call it
+
+	chunk.displayList = nullptr;
+	chunk.displayListSize = 0;
+	chunk.dirty = false;
+
+	if (tileCount == 0) return;
+
+	chunk.displayListSize = (3 + tileCount * 4 * bytesPerVertex + 31) & ~31u;
+	chunk.displayList = static_cast<unsigned char *>(memalign(32, chunk.displayListSize));
+
+	unsigned char *out = chunk.displayList;
+
+	*out++ = GX_QUADS | love::graphics::tileVertexFormat;
+	out = writeU16(out, tileCount * 4);
+
+	for (unsigned int y = chunkY * chunkSize; y < endY; y++) {
+		for (unsigned int x = chunkX * chunkSize; x < endX; x++) {
+			unsigned int tile = tiles[y * columns + x];
+
+			if (tile == 0) continue;
+
+			unsigned int corner = (y - chunkY * chunkSize) * cornersPerRow + (x - chunkX * chunkSize);
+			unsigned int positionIndices[4] = {corner, corner + 1, corner + cornersPerRow + 1, corner + cornersPerRow};
+
+			for (unsigned int i = 0; i < 4; i++) {
+				out = writeU16(out, positionIndices[i]);
+				*out++ = 0; // The draw color
+				out = writeU16(out, (tile - 1) * 4 + i);
+			}
+		}
+	}
+
+	std::memset(out, 0, chunk.displayList + chunk.displayListSize - out); // GX_NOP padding
+	DCFlushRange(chunk.displayList, chunk.displayListSize);
+}
+void TileMap::updateTexCoords() { // Written to a new array, earlier draws may still index the old one
+	float textureWidth = texture.texture->width, textureHeight = texture.texture->height;
+	float *updated = static_cast<float *>(memalign(32, atlasTiles * 4 * 2 * sizeof(float)));
+
+	for (unsigned int tile = 1; tile <= atlasTiles; tile++) {
+		unsigned int source = remap[tile] - 1;
+		float u0 = (source % atlasColumns) * tileWidth / textureWidth, v0 = (source / atlasColumns) * tileHeight / textureHeight;
+		float u1 = u0 + tileWidth / textureWidth, v1 = v0 + tileHeight / textureHeight;
+		float *corners = &updated[(tile - 1) * 8];
+
+		corners[0] = u0; corners[1] = v0;
+		corners[2] = u1; corners[3] = v0;
+		corners[4] = u1; corners[5] = v1;
+		corners[6] = u0; corners[7] = v1;
+	}
+
+	DCFlushRange(updated, atlasTiles * 4 * 2 * sizeof(float));
+	GX_InvalidateVtxCache();
+
+	love::graphics::releaseAfterFrame(texCoords);
+	texCoords = updated;
+
+	texCoordsDirty = false;
+}
+
+// Rendering
+unsigned int TileMap::render(const Mtx matrix, float left, float top, float right, float bottom, unsigned int &vertexBytes) {
+	unsigned int chunkWidth = chunkSize * tileWidth, chunkHeight = chunkSize * tileHeight;
+	// Clamped as floats first, the bounds can be far outside the map
+	int firstX = std::clamp<float>(std::floor(left / chunkWidth), 0.0f, chunkColumns), lastX = std::clamp<float>(std::floor(right / chunkWidth), -1.0f, chunkColumns - 1.0f);
+	int firstY = std::clamp<float>(std::floor(top / chunkHeight), 0.0f, chunkRows), lastY = std::clamp<float>(std::floor(bottom / chunkHeight), -1.0f, chunkRows - 1.0f);
+	unsigned int drawn = 0;
+	Mtx chunkMatrix;
+
+	if (texCoordsDirty) updateTexCoords();
+
+	GX_SetArray(GX_VA_POS, positions, 2 * sizeof(short));
+	GX_SetArray(GX_VA_TEX0, texCoords, 2 * sizeof(float));
+
+	std::memcpy(chunkMatrix, matrix, sizeof(Mtx));
+
+	for (int chunkY = firstY; chunkY <= lastY; chunkY++) {
+		for (int chunkX = firstX; chunkX <= lastX; chunkX++) {
+			Chunk &chunk = chunks[chunkY * chunkColumns + chunkX];
+
+			if (chunk.dirty) buildChunk(chunkX, chunkY);
+			if (chunk.displayList == nullptr) continue;
+
+			// Chunks are built in local coordinates, so move the matrix to the chunk's corner
+			float offsetX = chunkX * chunkWidth, offsetY = chunkY * chunkHeight;
+
+			chunkMatrix[0][3] = matrix[0][0] * offsetX + matrix[0][1] * offsetY + matrix[0][3];
+			chunkMatrix[1][3] = matrix[1][0] * offsetX + matrix[1][1] * offsetY + matrix[1][3];
+			love::graphics::setMatrix(chunkMatrix);
+
+			GX_CallDispList(chunk.displayList, chunk.displayListSize);
+
+			vertexBytes += chunk.displayListSize;
+			drawn++;
+		}
+	}
+
+	return drawn;
+}
+
+// Object functions
+TileMap *TileMap::clone() {
+	return new TileMap(*this);
+}
+void TileMap::release() { delete this; }
+
+// Destructor
+TileMap::~TileMap() { // The GPU may still be reading the arrays and display lists of this frame or the previous one
+	for (Chunk &chunk : chunks) love::graphics::releaseAfterFrame(chunk.displayList);
+
+	love::graphics::releaseAfterFrame(positions);
+	love::graphics::releaseAfterFrame(texCoords);
+}
+
+} // graphics
+} // love
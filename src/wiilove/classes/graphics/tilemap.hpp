@@ -0,0 +1,91 @@
+/* WiiLÖVE TileMap class
+ *
+ * This file is part of WiiLÖVE.
+ *
+ * Copyright (C) 2022  HTV04
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+// Libraries
+#include <grrlib-mod.h>
+#include <utility>
+#include <vector>
+
+// Classes
+#include "texture.hpp"
+
+namespace love {
+namespace graphics {
+
+// A grid of tiles from a texture atlas, split into chunks that are each compiled into a GX display list.
+// Tile 0 is empty, tiles 1 and up are read from the atlas left to right, top to bottom.
+class TileMap {
+	private:
+		struct Chunk {
+			unsigned char *displayList;
+			unsigned int displayListSize; // Bytes, a multiple of 32
+			bool dirty; // Rebuilt before its next draw
+		};
+
+		unsigned int tileWidth, tileHeight;
+		unsigned int columns, rows;
+		unsigned int atlasColumns, atlasTiles;
+
+		std::vector<unsigned short> tiles;
+		std::vector<unsigned short> remap; // Atlas tile each tile index is drawn with, for animation
+
+		unsigned int chunkColumns, chunkRows;
+		std::vector<Chunk> chunks;
+
+		short *positions; // Chunk-local corner grid, shared by every chunk
+		float *texCoords; // Four corners per tile index, replaced whenever the remap table changes
+		bool texCoordsDirty;
+
+		void init();
+		void buildChunk(unsigned int chunkX, unsigned int chunkY);
+		void updateTexCoords();
+
+	public:
+		static constexpr unsigned int chunkSize = 16; // Tiles per chunk side
+
+		Texture texture;
+
+		TileMap(const Texture &texture, unsigned int tileWidth, unsigned int tileHeight, unsigned int columns, unsigned int rows);
+
+		TileMap(const TileMap &other);
+
+		std::pair<unsigned int, unsigned int> getDimensions();
+		std::pair<unsigned int, unsigned int> getTileDimensions();
+		unsigned int getTile(unsigned int x, unsigned int y);
+		unsigned int getTileRemap(unsigned int tile);
+		void setTile(unsigned int x, unsigned int y, unsigned int tile);
+		void setTileRemap(unsigned int tile, unsigned int target);
+
+		// Draws the chunks overlapping the map-space rectangle with arrays and vertex format already set up,
+		// returns the number of chunks drawn
+		unsigned int render(const Mtx matrix, float left, float top, float right, float bottom, unsigned int &vertexBytes);
+
+		TileMap *clone();
+		void release();
+
+		~TileMap();
+};
+
+} // graphics
+} // love
@@ -0,0 +1,518 @@
+/* WiiLÖVE Video class
+ *
+ * This file is part of WiiLÖVE.
+ *
+ * Copyright (C) 2022  HTV04
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+
+// Libraries
+#include <grrlib-mod.h>
+#include <ogc/lwp_watchdog.h>
+#include <sol/sol.hpp>
+#include <malloc.h>
+#include <algorithm>
+#include <csetjmp>
+#include <cstdio>
+#include <jpeglib.h> // Needs size_t and FILE declared first
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+#include <stdexcept>
+
+// Classes
+#include "../audio/source.hpp"
+#include "imagedata.hpp"
+#include "texture.hpp"
+
+// Modules
+#include "../../modules/filesystem.hpp"
+#include "../../modules/graphics.hpp"
+
+// Header
+#include "video.hpp"
+
+namespace love {
+namespace graphics {
+
+// Local variables
+namespace {
+#if defined(GEKKO)
+	constexpr unsigned char decodePriority = LWP_PRIO_NORMAL - 8; // Below the main thread, above the loader
+	constexpr unsigned int decodeStackSize = 64 * 1024;
+#endif // GEKKO
+
+	constexpr unsigned int indexInterval = 32; // Frames between seek points
+	constexpr unsigned int entropyChunkSize = 4096;
+
+	struct JPEGError {
+		jpeg_error_mgr manager;
+		jmp_buf jump;
+	};
+
+	void exitJPEG(j_common_ptr info) {
+		std::longjmp(reinterpret_cast<JPEGError *>(info->err)->jump, 1);
+	}
+}
+
+// Big-endian marker fields. A static member rather than a local helper, texture.cpp has its own in the unity build
+unsigned int Video::readBE16(const unsigned char *bytes) { return (bytes[0] << 8) | bytes[1]; }
+
+// Constructor
+Video::Video(const char *filename, double fps) : filename(filename), fps(fps) {
+	if (fps <= 0.0) { throw std::runtime_error("Invalid frame rate"); }
+
+	open();
+}
+
+// Clone constructor, opens its own stream of the same file
+Video::Video(const Video &other) : filename(other.filename), fps(other.fps) {
+	open();
+}
+
+void Video::open() {
+	file = std::fopen(love::filesystem::getFilePath(filename).c_str(), "rb");
+
+	if (file == nullptr) { throw std::runtime_error("Could not open " + filename); }
+
+	nextFrame = 0;
+
+	if (!readFrame() || frameWidth == 0 || frameHeight == 0) {
+		std::fclose(file);
+
+		throw std::runtime_error("Not an MJPEG video: " + filename);
+	}
+	width = frameWidth;
+	height = frameHeight;
+
+	if (width > 1024 || height > 1024) {
+		std::fclose(file);
+
+		throw std::runtime_error("Video is larger than 1024x1024: " + filename);
+	}
+
+	rowData.resize(width * 3 * 4);
+
+	frame = new Texture(ImageData(width, height, "rgb565"));
+	frameSize = frame->size;
+
+	if (!decodeFrame(static_cast<unsigned char *>(frame->texture->data))) {
+		delete frame;
+		std::fclose(file);
+
+		throw std::runtime_error("Could not decode " + filename);
+	}
+
+	backBuffer = static_cast<unsigned char *>(memalign(32, frameSize));
+	backFrame = -1;
+	seekFrame = -1;
+	dueFrame = 0;
+	droppedFrames = 0;
+	ended = false;
+	quitting = false;
+	shownFrame = 0;
+	swapPresent = love::graphics::getPresentCount() - 1; // Free to swap before the next present
+
+	playing = false;
+	clockBase = 0.0;
+	clockStart = 0;
+	audioSource = nullptr;
+	sourceOffset = 0.0;
+
+#if defined(GEKKO)
+	LWP_MutexInit(&mutex, false);
+	LWP_CondInit(&condition);
+	LWP_CreateThread(&thread, decode, this, nullptr, decodeStackSize, decodePriority);
+#else
+	pthread_mutex_init(&mutex, nullptr);
+	pthread_cond_init(&condition, nullptr);
+	pthread_create(&thread, nullptr, decode, this);
+#endif // GEKKO
+}
+
+// Locking
+#if defined(GEKKO)
+void Video::lock() { LWP_MutexLock(mutex); }
+void Video::unlock() { LWP_MutexUnlock(mutex); }
+void Video::wait() { LWP_CondWait(condition, mutex); }
+void Video::signal() { LWP_CondSignal(condition); }
+#else
+void Video::lock() { pthread_mutex_lock(&mutex); }
+void Video::unlock() { pthread_mutex_unlock(&mutex); }
+void Video::wait() { pthread_cond_wait(&condition, &mutex); }
+void Video::signal() { pthread_cond_signal(&condition); }
+#endif // GEKKO
+
+// Decode thread
+void *Video::decode(void *video) {
+	static_cast<Video *>(video)->run();
+
+	return nullptr;
+}
+void Video::run() {
+	lock();
+
+	while (true) {
+		while (!quitting && seekFrame < 0 && (backFrame >= 0 || ended)) wait();
+
+		if (quitting) break;
+
+		if (seekFrame >= 0) {
+			unsigned int target = seekFrame;
+
+			seekFrame = -1;
+			ended = false;
+
+			unlock();
+			seekTo(target);
+			lock();
+
+			continue;
+		}
+
+		unsigned int due = dueFrame;
+
+		unlock();
+
+		// Frames that are already late are parsed but not decoded
+		unsigned int skipped = 0;
+		bool found = false;
+
+		while (readFrame()) {
+			if (nextFrame - 1 >= due) {
+				found = true;
+
+				break;
+			}
+
+			skipped++;
+		}
+
+		bool decoded = found && frameWidth == width && frameHeight == height && decodeFrame(backBuffer); // Other sizes don't fit the buffers
+
+		lock();
+
+		droppedFrames += skipped;
+
+		if (seekFrame >= 0) continue; // Sought while decoding, the frame is stale
+
+		if (decoded)
+			backFrame = nextFrame - 1;
+		else if (!found)
+			ended = true;
+		else
+			droppedFrames++; // Corrupt or a different size, skipped
+	}
+
+	unlock();
+}
+
+// Reads the next JPEG into frameData by walking its markers, so bytes inside segments can't be mistaken for the end
+bool Video::readFrame() {
+	unsigned char bytes[4];
+	long offset = std::ftell(file);
+
+	frameData.clear();
+	frameWidth = 0;
+	frameHeight = 0;
+
+	if (std::fread(bytes, 1, 2, file) != 2 || bytes[0] != 0xff || bytes[1] != 0xd8) return false; // SOI
+
+	frameData.insert(frameData.end(), bytes, bytes + 2);
+
+	while (true) {
+		int marker;
+
+		if (std::fgetc(file) != 0xff) return false;
+
+		do { marker = std::fgetc(file); } while (marker == 0xff); // Fill bytes
+
+		if (marker == EOF) return false;
+
+		frameData.push_back(0xff);
+		frameData.push_back(marker);
+
+		if (marker == 0xd9) break; // EOI
+		if (marker == 0x01 || (marker >= 0xd0 && marker <= 0xd7)) continue; // No length
+
+		if (std::fread(bytes, 1, 2, file) != 2) return false;
+
+		unsigned int length = readBE16(bytes);
+		unsigned int start = frameData.size();
+
+		if (length < 2) return false;
+
+		frameData.insert(frameData.end(), bytes, bytes + 2);
+		frameData.resize(start + length);
+
+		if (std::fread(&frameData[start + 2], 1, length - 2, file) != length - 2) return false;
+
+		if (marker >= 0xc0 && marker <= 0xc2 && length >= 8) { // SOF0-2
+			frameHeight = readBE16(&frameData[start + 3]);
+			frameWidth = readBE16(&frameData[start + 5]);
+		} else if (marker == 0xda && !readEntropyData()) { // SOS
+			return false;
+		}
+	}
+
+	if (nextFrame % indexInterval == 0 && nextFrame / indexInterval == frameOffsets.size()) frameOffsets.push_back(offset);
+
+	nextFrame++;
+
+	return true;
+}
+// Appends scan data up to the next marker, leaving the file at that marker
+bool Video::readEntropyData() {
+	unsigned int scanned = frameData.size();
+
+	while (true) {
+		unsigned int start = frameData.size();
+
+		frameData.resize(start + entropyChunkSize);
+		frameData.resize(start + std::fread(&frameData[start], 1, entropyChunkSize, file));
+
+		if (frameData.size() == start) return false;
+
+		for (; scanned + 1 < frameData.size(); scanned++) {
+			unsigned char next = frameData[scanned + 1];
+
+			// Stuffed 0xff00 and restart markers belong to the scan, fill bytes lead to a marker
+			if (frameData[scanned] != 0xff || next == 0x00 || next == 0xff || (next >= 0xd0 && next <= 0xd7)) continue;
+
+			std::fseek(file, -static_cast<long>(frameData.size() - scanned), SEEK_CUR);
+			frameData.resize(scanned);
+
+			return true;
+		}
+	}
+}
+// Decodes frameData into RGB565 tiles, the layout of the frame texture
+bool Video::decodeFrame(unsigned char *pixels) {
+	jpeg_decompress_struct info;
+	JPEGError error;
+	unsigned int tilesPerRow = (width + 3) / 4;
+
+	info.err = jpeg_std_error(&error.manager);
+	error.manager.error_exit = exitJPEG;
+
+	if (setjmp(error.jump)) { // libjpeg errors land here
+		jpeg_destroy_decompress(&info);
+
+		return false;
+	}
+
+	jpeg_create_decompress(&info);
+	jpeg_mem_src(&info, frameData.data(), frameData.size());
+	jpeg_read_header(&info, TRUE);
+
+	info.out_color_space = JCS_RGB;
+	info.dct_method = JDCT_IFAST;
+	info.do_fancy_upsampling = FALSE;
+
+	jpeg_start_decompress(&info);
+
+	if (info.output_width != width || info.output_height != height) {
+		jpeg_destroy_decompress(&info);
+
+		return false;
+	}
+
+	while (info.output_scanline < height) {
+		unsigned int y = info.output_scanline;
+		JSAMPROW rowPointers[4] = {&rowData[0], &rowData[width * 3], &rowData[width * 6], &rowData[width * 9]};
+		unsigned int count = 0;
+
+		while (count < 4 && info.output_scanline < height) count += jpeg_read_scanlines(&info, rowPointers + count, 4 - count);
+
+		for (unsigned int row = 0; row < count; row++) {
+			unsigned char *tileRow = pixels + ((y + row) / 4) * tilesPerRow * 32 + ((y + row) % 4) * 8;
+			const unsigned char *rgb = rowPointers[row];
+
+			for (unsigned int x = 0; x < width; x++, rgb += 3) {
+				unsigned int value = ((rgb[0] & 0xf8) << 8) | ((rgb[1] & 0xfc) << 3) | (rgb[2] >> 3);
+				unsigned char *texel = tileRow + (x / 4) * 32 + (x % 4) * 2;
+
+				texel[0] = value >> 8;
+				texel[1] = value & 0xff;
+			}
+		}
+	}
+
+	jpeg_finish_decompress(&info);
+	jpeg_destroy_decompress(&info);
+
+	DCFlushRange(pixels, frameSize);
+
+	return true;
+}
+void Video::seekTo(unsigned int target) { // Jumps to the nearest seek point, then parses forward
+	unsigned int point = std::min<unsigned int>(target / indexInterval, frameOffsets.size() - 1);
+
+	if (nextFrame > target || nextFrame < point * indexInterval) {
+		std::fseek(file, frameOffsets[point], SEEK_SET);
+		nextFrame = point * indexInterval;
+	}
+
+	while (nextFrame < target) {
+		long offset = std::ftell(file);
+
+		if (!readFrame()) { // Past the end, stay on the last frame
+			std::fseek(file, offset, SEEK_SET);
+
+			break;
+		}
+	}
+}
+
+// Video properties
+unsigned int Video::getWidth() { return width; }
+unsigned int Video::getHeight() { return height; }
+std::pair<unsigned int, unsigned int> Video::getDimensions() {
+	return std::make_pair(width, height);
+}
+unsigned int Video::getDroppedFrames() {
+	lock();
+
+	unsigned int dropped = droppedFrames;
+
+	unlock();
+
+	return dropped;
+}
+double Video::getFPS() { return fps; }
+sol::object Video::getSource() { return source; }
+Texture Video::getTexture() { return getFrame(); }
+bool Video::isPlaying() { return playing; }
+void Video::setSource(sol::object source) { // The video follows the source's position from now on
+	double time = tell();
+
+	this->source = source;
+	audioSource = source.is<love::audio::Source>() ? &source.as<love::audio::Source &>() : nullptr;
+
+	if (audioSource != nullptr) sourceOffset = time - audioSource->tell();
+}
+
+// Playback
+void Video::pause() {
+	if (!playing) return;
+
+	clockBase = tell();
+	playing = false;
+
+	if (audioSource != nullptr) audioSource->pause();
+}
+void Video::play() {
+	if (playing) return;
+
+	clockStart = gettime();
+	playing = true;
+
+	if (audioSource != nullptr) audioSource->play();
+}
+void Video::rewind() { seek(0.0); }
+void Video::seek(double offset) {
+	offset = std::max(offset, 0.0);
+
+	clockBase = offset;
+	clockStart = gettime();
+
+	if (audioSource != nullptr) sourceOffset = offset - audioSource->tell();
+
+	lock();
+
+	seekFrame = offset * fps;
+	backFrame = -1;
+	dueFrame = seekFrame;
+	signal();
+
+	unlock();
+}
+double Video::tell() {
+	if (audioSource != nullptr) return sourceOffset + audioSource->tell();
+	if (!playing) return clockBase;
+
+	return clockBase + static_cast<double>(diff_usec(clockStart, gettime())) / 1000000.0;
+}
+
+// Rendering
+const Texture &Video::getFrame() {
+	unsigned int due = std::max(tell(), 0.0) * fps;
+
+	lock();
+
+	dueFrame = due;
+
+	bool finished = ended && backFrame < 0;
+
+	// Draws earlier in this frame already show the front buffer, swapping again would change them mid-frame
+	if (backFrame >= 0 && static_cast<unsigned int>(backFrame) <= due && swapPresent != love::graphics::getPresentCount()) {
+		love::graphics::flushBatch(); // Quads already batched show the previous frame
+		love::graphics::waitForFrame(); // So does a frame still drawing
+
+		std::swap(frame->texture->data, reinterpret_cast<void *&>(backBuffer));
+
+		shownFrame = backFrame;
+		swapPresent = love::graphics::getPresentCount();
+		backFrame = -1;
+		signal();
+	}
+
+	unlock();
+
+	if (finished) pause(); // Stay on the last frame
+
+	return *frame;
+}
+
+// Object functions
+Video *Video::clone() {
+	return new Video(*this);
+}
+void Video::release() { delete this; }
+
+// Destructor
+Video::~Video() {
+	lock();
+
+	quitting = true;
+	signal();
+
+	unlock();
+
+#if defined(GEKKO)
+	LWP_JoinThread(thread, nullptr);
+	LWP_MutexDestroy(mutex);
+	LWP_CondDestroy(condition);
+#else
+	pthread_join(thread, nullptr);
+	pthread_mutex_destroy(&mutex);
+	pthread_cond_destroy(&condition);
+#endif // GEKKO
+
+	std::fclose(file);
+
+	love::graphics::flushBatch();
+	love::graphics::waitForFrame();
+
+	std::free(backBuffer);
+	delete frame;
+}
+
+} // graphics
+} // love
@@ -0,0 +1,140 @@
+/* WiiLÖVE Video class
+ *
+ * This file is part of WiiLÖVE.
+ *
+ * Copyright (C) 2022  HTV04
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+// Libraries
+#include <sol/sol.hpp>
+#if defined(GEKKO)
+#include <gccore.h>
+#else
+#include <pthread.h>
+#endif // GEKKO
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Classes
+#include "texture.hpp"
+
+namespace love {
+namespace audio {
+class Source;
+} // audio
+
+namespace graphics {
+
+// Motion JPEG video (concatenated baseline JPEG frames, like ffmpeg's "mjpeg" output) streamed from disk.
+// A decode thread fills a back buffer while the front one is shown, so memory doesn't depend on the length.
+class Video {
+	private:
+		std::string filename;
+		double fps;
+		unsigned int width, height; // Of the first frame, fixed once opened since the buffers are sized for it
+		unsigned int frameSize; // Bytes of one RGB565 frame
+
+		// Decode thread state, only touched by the constructor before the thread starts
+		FILE *file;
+		std::vector<unsigned char> frameData; // Compressed frame, reused
+		unsigned int frameWidth, frameHeight; // From frameData's SOF, 0 without one
+		std::vector<unsigned char> rowData; // Four decoded RGB rows, one tile row
+		std::vector<long> frameOffsets; // File offset of every indexInterval-th frame, for seeking
+		unsigned int nextFrame; // Frame at the file position
+
+		// Shared with the decode thread, under the lock
+		unsigned char *backBuffer;
+		int backFrame; // Frame in the back buffer, -1 while it's free
+		int seekFrame; // -1 unless a seek is pending
+		unsigned int dueFrame; // Frame the clock is at, older ones are skipped
+		unsigned int droppedFrames;
+		bool ended;
+		bool quitting;
+
+		Texture *frame; // Front buffer
+		unsigned int shownFrame;
+		unsigned int swapPresent; // Present count at the last swap, the front buffer changes at most once per frame
+
+		// Clock
+		bool playing;
+		double clockBase; // Seconds at clockStart, or while paused
+		unsigned long long clockStart;
+		sol::object source; // Keeps the source alive
+		love::audio::Source *audioSource; // Drives the clock when set
+		double sourceOffset;
+
+#if defined(GEKKO)
+		lwp_t thread;
+		mutex_t mutex;
+		cond_t condition;
+#else
+		pthread_t thread;
+		pthread_mutex_t mutex;
+		pthread_cond_t condition;
+#endif // GEKKO
+
+		void lock();
+		void unlock();
+		void wait();
+		void signal();
+
+		static void *decode(void *video);
+		void run();
+		static unsigned int readBE16(const unsigned char *bytes);
+		bool readFrame();
+		bool readEntropyData();
+		bool decodeFrame(unsigned char *pixels);
+		void seekTo(unsigned int target);
+
+		void open();
+
+	public:
+		Video(const char *filename, double fps);
+
+		Video(const Video &other);
+
+		unsigned int getWidth();
+		unsigned int getHeight();
+		std::pair<unsigned int, unsigned int> getDimensions();
+		unsigned int getDroppedFrames();
+		double getFPS();
+		sol::object getSource();
+		Texture getTexture();
+		bool isPlaying();
+		void setSource(sol::object source);
+
+		void pause();
+		void play();
+		void rewind();
+		void seek(double offset);
+		double tell();
+
+		const Texture &getFrame(); // Shows the newest decoded frame that is due and returns the front buffer
+
+		Video *clone();
+		void release();
+
+		~Video();
+};
+
+} // graphics
+} // love
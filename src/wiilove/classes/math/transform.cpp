@@ -0,0 +1,134 @@
+/* WiiLÖVE Transform class
+ *
+ * This file is part of WiiLÖVE.
+ *
+ * Copyright (C) 2022  HTV04
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+// Libraries
+#include <ogc/gu.h>
+#include <utility>
+#include <stdexcept>
+
+// Header
+#include "transform.hpp"
+
+namespace love {
+namespace math {
+
+// Constructors
+Transform::Transform() {
+	guMtxIdentity(matrix);
+}
+Transform::Transform(float x, float y, float angle, float sx, float sy, float ox, float oy) {
+	setTransformation(x, y, angle, sx, sy, ox, oy);
+}
+
+// Clone constructor
+Transform::Transform(const Transform &other) {
+	guMtxCopy(other.matrix, matrix);
+}
+
+// Transform functions (each one is applied in the local space of the previous ones, like love.graphics)
+Transform *Transform::apply(const Transform &other) {
+	guMtxConcat(matrix, other.matrix, matrix);
+
+	return this;
+}
+Transform *Transform::reset() {
+	guMtxIdentity(matrix);
+
+	return this;
+}
+Transform *Transform::rotate(float angle) { // Degrees, like love.graphics.rotate
+	Mtx rotation;
+
+	guMtxRotDeg(rotation, 'z', angle);
+	guMtxConcat(matrix, rotation, matrix);
+
+	return this;
+}
+Transform *Transform::scale(float sx, float sy) {
+	Mtx scaling;
+
+	guMtxScale(scaling, sx, sy, 1.0f);
+	guMtxConcat(matrix, scaling, matrix);
+
+	return this;
+}
+Transform *Transform::setTransformation(float x, float y, float angle, float sx, float sy, float ox, float oy) {
+	// Composes translate(x, y) * rotate(angle) * scale(sx, sy) * translate(-ox, -oy) in one go
+	Mtx rotation;
+
+	guMtxRotDeg(rotation, 'z', angle);
+
+	for (int row = 0; row < 2; row++) {
+		float a = rotation[row][0] * sx;
+		float b = rotation[row][1] * sy;
+
+		matrix[row][0] = a;
+		matrix[row][1] = b;
+		matrix[row][2] = 0.0f;
+		matrix[row][3] = (row == 0 ? x : y) - a * ox - b * oy;
+	}
+	matrix[2][0] = 0.0f;
+	matrix[2][1] = 0.0f;
+	matrix[2][2] = 1.0f;
+	matrix[2][3] = 0.0f;
+
+	return this;
+}
+Transform *Transform::translate(float dx, float dy) {
+	Mtx translation;
+
+	guMtxTrans(translation, dx, dy, 0.0f);
+	guMtxConcat(matrix, translation, matrix);
+
+	return this;
+}
+
+// Querying functions
+Transform *Transform::inverse() {
+	Transform *inverted = new Transform();
+
+	if (guMtxInverse(matrix, inverted->matrix) == 0) {
+		delete inverted;
+
+		throw std::runtime_error("Transform is not invertible");
+	}
+
+	return inverted;
+}
+std::pair<float, float> Transform::inverseTransformPoint(float x, float y) {
+	Mtx inverted;
+
+	if (guMtxInverse(matrix, inverted) == 0) { throw std::runtime_error("Transform is not invertible"); }
+
+	return std::make_pair(inverted[0][0] * x + inverted[0][1] * y + inverted[0][3], inverted[1][0] * x + inverted[1][1] * y + inverted[1][3]);
+}
+std::pair<float, float> Transform::transformPoint(float x, float y) {
+	return std::make_pair(matrix[0][0] * x + matrix[0][1] * y + matrix[0][3], matrix[1][0] * x + matrix[1][1] * y + matrix[1][3]);
+}
+
+// Object functions
+Transform *Transform::clone() {
+	return new Transform(*this);
+}
+void Transform::release() { delete this; }
+
+} // math
+} // love
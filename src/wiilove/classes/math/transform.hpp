@@ -0,0 +1,56 @@
+/* WiiLÖVE Transform class
+ *
+ * This file is part of WiiLÖVE.
+ *
+ * Copyright (C) 2022  HTV04
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Libraries
+#include <ogc/gu.h>
+#include <utility>
+
+namespace love {
+namespace math {
+
+class Transform {
+	public:
+		Mtx matrix; // Affine 2D transform, same layout as the GRRLIB matrix
+
+		Transform();
+		Transform(float x, float y, float angle, float sx, float sy, float ox, float oy);
+
+		Transform(const Transform &other);
+
+		Transform *apply(const Transform &other);
+		Transform *reset();
+		Transform *rotate(float angle);
+		Transform *scale(float sx, float sy);
+		Transform *setTransformation(float x, float y, float angle, float sx, float sy, float ox, float oy);
+		Transform *translate(float dx, float dy);
+
+		Transform *inverse();
+		std::pair<float, float> inverseTransformPoint(float x, float y);
+		std::pair<float, float> transformPoint(float x, float y);
+
+		Transform *clone();
+		void release();
+};
+
+} // math
+} // love
@@ -155,6 +155,7 @@ void FreeTypeGX::unloadFont() {
 	}
 
 	this->cacheTextWidth.clear();
+	this->glyphTable.clear();
 	this->fontData.clear();
 }
 
@@ -225,6 +226,22 @@ void FreeTypeGX::clearTextWidthCache() {
 	this->cacheTextWidth.clear();
 }
 
+/**
+ * Sets the faces used for characters missing from this face.
+ *
+ * This routine replaces the fallback chain and forgets every resolution made through the previous one. Fallback faces are
+ * only probed for their own glyphs, their fallbacks are not followed. The caller keeps the fallback faces alive for as long
+ * as they are set.
+ *
+ * @param fallbacks	Faces to probe, in order.
+ */
+void FreeTypeGX::setFallbacks(const std::vector<FreeTypeGX*> &fallbacks) {
+	this->fallbacks = fallbacks;
+
+	this->glyphTable.clear();
+	this->cacheTextWidth.clear();
+}
+
 /**
  * Adjusts the texture data buffer to necessary width for a given texture format.
  *
@@ -459,6 +476,39 @@ ftgxCharData* FreeTypeGX::getCharacter(wchar_t character) {
 	return this->cacheGlyphData(character);
 }
 
+/**
+ * Returns the face and font character data structure that render a character.
+ *
+ * This routine looks the character up in this face first, then in each fallback face in order. A face only answers if it maps
+ * the character to a real glyph, otherwise this face's missing glyph is used. The result is memoized so the chain is probed
+ * once per character rather than on every draw.
+ *
+ * @param character	Character whose information needs to be retrieved.
+ * @return The resolved face and font structure for the supplied character.
+ */
+ftgxGlyph FreeTypeGX::resolveCharacter(wchar_t character) {
+	auto entry = this->glyphTable.find(character);
+
+	if(entry != this->glyphTable.end()) {
+		return entry->second;
+	}
+
+	ftgxGlyph glyph = {this, NULL};
+
+	if(FT_Get_Char_Index(this->ftFace, character) == 0) {
+		for(FreeTypeGX *fallback : this->fallbacks) {
+			if(FT_Get_Char_Index(fallback->ftFace, character) != 0) {
+				glyph.face = fallback;
+				break;
+			}
+		}
+	}
+
+	glyph.charData = glyph.face->getCharacter(character);
+
+	return this->glyphTable[character] = glyph;
+}
+
 /**
  * Processes the supplied text string and prints the results at the specified coordinates.
  *
@@ -469,13 +519,15 @@ ftgxCharData* FreeTypeGX::getCharacter(wchar_t character) {
  * @param y Screen Y coordinate at which to output the text. Note that this value corresponds to the text string origin and not the top or bottom of the glyphs.
  * @param text	NULL terminated string to output.
  * @param textStyle	Flags which specify any styling which should be applied to the rendered string.
+ * @param colors	Optional colors, one per character of text. If not specified every glyph uses the current GRRLIB color.
  * @return The number of characters printed.
  */
-int FreeTypeGX::drawText(float x, float y, const wchar_t *text, float scaleX, float scaleY, float offsetX, float offsetY, float degrees, int textStyle) {
+int FreeTypeGX::drawText(float x, float y, const wchar_t *text, float scaleX, float scaleY, float offsetX, float offsetY, float degrees, int textStyle, const uint32_t *colors) {
 	float x_pos = x, printed = 0;
 	float x_offset = 0, y_offset = -this->ftHeight * scaleY;
 	GXTexObj glyphTexture;
 	FT_Vector pairDelta;
+	ftgxGlyph previous = {NULL, NULL};
 
 	int textWidth = 0;
 
@@ -491,7 +543,7 @@ int FreeTypeGX::drawText(float x, float y, const wchar_t *text, float scaleX, fl
 		y_offset += static_cast<float>(this->getStyleOffsetHeight(textStyle)) * scaleY;
 	}
 
-	for (size_t i = 0; i < wcslen(text); i++) {
+	for (size_t i = 0, length = wcslen(text); i < length; i++) {
 		switch (text[i]) {
 			case L'\t':
 				x_pos += static_cast<float>(getCharacter(L' ')->glyphAdvanceX) * scaleX * 4;
@@ -501,6 +553,7 @@ int FreeTypeGX::drawText(float x, float y, const wchar_t *text, float scaleX, fl
 			case L'\n':
 				x_pos = x;
 				y_offset -= this->ftHeight * scaleY;
+				previous.charData = NULL;
 
 				continue;
 
@@ -511,20 +564,23 @@ int FreeTypeGX::drawText(float x, float y, const wchar_t *text, float scaleX, fl
 		if((maxVideoWidth > 0) && (x_pos > maxVideoWidth))
 			continue;
 
-		ftgxCharData* glyphData = getCharacter(text[i]);
+		ftgxGlyph glyph = resolveCharacter(text[i]);
+		ftgxCharData* glyphData = glyph.charData;
 
 		if(glyphData != NULL) {
-			if(this->ftKerningEnabled && i) {
-				FT_Get_Kerning(this->ftFace, this->fontData[text[i - 1]].glyphIndex, glyphData->glyphIndex, FT_KERNING_DEFAULT, &pairDelta);
+			if(glyph.face->ftKerningEnabled && previous.face == glyph.face && previous.charData != NULL) { // Kerning only pairs glyphs of the same face
+				FT_Get_Kerning(glyph.face->ftFace, previous.charData->glyphIndex, glyphData->glyphIndex, FT_KERNING_DEFAULT, &pairDelta);
 				x_pos += static_cast<float>(pairDelta.x >> 6) * scaleX;
 			}
 
-			GX_InitTexObj(&glyphTexture, glyphData->glyphDataTexture, glyphData->textureWidth, glyphData->textureHeight, this->textureFormat, GX_CLAMP, GX_CLAMP, GX_FALSE);
-			this->copyTextureToFramebuffer(&glyphTexture, glyphData->textureWidth, glyphData->textureHeight, x_pos - x_offset, (y - y_offset) - (glyphData->renderOffsetMax * scaleY), scaleX, scaleY, offsetX, offsetY, degrees);
+			GX_InitTexObj(&glyphTexture, glyphData->glyphDataTexture, glyphData->textureWidth, glyphData->textureHeight, glyph.face->textureFormat, GX_CLAMP, GX_CLAMP, GX_FALSE);
+			this->copyTextureToFramebuffer(&glyphTexture, glyphData->textureWidth, glyphData->textureHeight, x_pos - x_offset, (y - y_offset) - (glyphData->renderOffsetMax * scaleY), scaleX, scaleY, offsetX, offsetY, degrees, colors != NULL ? colors[i] : GRRLIB_Settings.color);
 
 			x_pos += static_cast<float>(glyphData->glyphAdvanceX) * scaleX;
 			printed++;
 		}
+
+		previous = glyph;
 	}
 
 	// Broken with tabs and newlines right now
@@ -538,8 +594,8 @@ int FreeTypeGX::drawText(float x, float y, const wchar_t *text, float scaleX, fl
 /**
  * \overload
  */
-int FreeTypeGX::drawText(float x, float y, const std::wstring &text, float scaleX, float scaleY, float offsetX, float offsetY, float degrees, int textStyle) {
-	return this->drawText(x, y, text.c_str(), scaleX, scaleY, offsetX, offsetY, degrees, textStyle);
+int FreeTypeGX::drawText(float x, float y, const std::wstring &text, float scaleX, float scaleY, float offsetX, float offsetY, float degrees, int textStyle, const uint32_t *colors) {
+	return this->drawText(x, y, text.c_str(), scaleX, scaleY, offsetX, offsetY, degrees, textStyle, colors);
 }
 
 /**
@@ -578,8 +634,9 @@ int FreeTypeGX::getWidth(const wchar_t *text, float scaleX) {
 	int strWidth = 0;
 	FT_Vector pairDelta;
 	ftgxCharData* glyphData = NULL;
+	ftgxGlyph previous = {NULL, NULL};
 
-	for (size_t i = 0; i < wcslen(text); i++) {
+	for (size_t i = 0, length = wcslen(text); i < length; i++) {
 		strWidth = std::max(strWidth, lineWidth);
 
 		switch (text[i]) {
@@ -590,6 +647,7 @@ int FreeTypeGX::getWidth(const wchar_t *text, float scaleX) {
 
 			case L'\n':
 				lineWidth = 0;
+				previous.charData = NULL;
 
 				continue;
 
@@ -597,16 +655,19 @@ int FreeTypeGX::getWidth(const wchar_t *text, float scaleX) {
 				continue;
 		}
 
-		glyphData = getCharacter(text[i]);
+		ftgxGlyph glyph = resolveCharacter(text[i]);
+		glyphData = glyph.charData;
 
 		if(glyphData != NULL) {
-			if(this->ftKerningEnabled && (i > 0)) {
-				FT_Get_Kerning( this->ftFace, this->fontData[text[i - 1]].glyphIndex, glyphData->glyphIndex, FT_KERNING_DEFAULT, &pairDelta );
+			if(glyph.face->ftKerningEnabled && previous.face == glyph.face && previous.charData != NULL) {
+				FT_Get_Kerning( glyph.face->ftFace, previous.charData->glyphIndex, glyphData->glyphIndex, FT_KERNING_DEFAULT, &pairDelta );
 				strWidth += pairDelta.x >> 6;
 			}
 
 			lineWidth += glyphData->glyphAdvanceX;
 		}
+
+		previous = glyph;
 	}
 
 	return std::max(strWidth, lineWidth) * scaleX;
@@ -625,7 +686,7 @@ int FreeTypeGX::getHeight(const wchar_t *text, float scaleY) {
 	int strMax = this->ftHeight;
 	int strMin = 0;
 
-	for (size_t i = 0; i < wcslen(text); i++) {
+	for (size_t i = 0, length = wcslen(text); i < length; i++) {
 		switch (text[i]) {
 			case L'\t':
 				continue;
@@ -639,7 +700,7 @@ int FreeTypeGX::getHeight(const wchar_t *text, float scaleY) {
 				continue;
 	}
 
-		ftgxCharData* glyphData = getCharacter(text[i]);
+		ftgxCharData* glyphData = resolveCharacter(text[i]).charData;
 
 		if(glyphData != NULL) {
 			strMax = std::max(strMax, glyphData->renderOffsetMax);
@@ -650,6 +711,76 @@ int FreeTypeGX::getHeight(const wchar_t *text, float scaleY) {
 	return (this->ftHeight + strMax + strMin) * scaleY;
 }
 
+/**
+ * Returns the kerning between two resolved glyphs in pixels.
+ *
+ * Glyphs from different faces, or from a face without kerning data, are never kerned.
+ *
+ * @param left	The glyph on the left of the pair.
+ * @param right	The glyph on the right of the pair.
+ * @return The horizontal adjustment to apply before the right glyph.
+ */
+int FreeTypeGX::getKerning(const ftgxGlyph &left, const ftgxGlyph &right) {
+	FT_Vector pairDelta;
+
+	if(left.charData == NULL || right.charData == NULL || left.face != right.face || !right.face->ftKerningEnabled)
+		return 0;
+
+	FT_Get_Kerning(right.face->ftFace, left.charData->glyphIndex, right.charData->glyphIndex, FT_KERNING_DEFAULT, &pairDelta);
+
+	return pairDelta.x >> 6;
+}
+
+/**
+ * Returns the distance between two baselines in pixels.
+ *
+ * @return The line height of this face.
+ */
+int FreeTypeGX::getLineHeight() {
+	return this->ftHeight;
+}
+
+/**
+ * Returns the widest glyph advance of this face and its fallbacks in pixels.
+ *
+ * This routine reads the face metrics only, so it gives a cheap upper bound on the width of a line of text.
+ *
+ * @return The widest advance of any glyph the text can be drawn with.
+ */
+int FreeTypeGX::getMaxAdvance() {
+	FT_Pos maxAdvance = this->ftFace->size->metrics.max_advance;
+
+	for(FreeTypeGX *fallback : this->fallbacks) {
+		maxAdvance = std::max(maxAdvance, fallback->ftFace->size->metrics.max_advance);
+	}
+
+	return (maxAdvance + 63) >> 6;
+}
+
+/**
+ * Renders a resolved glyph into an 8-bit coverage bitmap.
+ *
+ * This routine renders the glyph with the same hinting as the cached glyph textures, but leaves the result in the owning
+ * face's glyph slot instead of converting it to a texture. The bitmap stays valid until that face loads another glyph.
+ *
+ * @param glyph	The glyph to render.
+ * @param top	Receives the distance from the baseline to the top row of the bitmap.
+ * @return The rendered bitmap, or NULL if the glyph could not be rendered.
+ */
+FT_Bitmap* FreeTypeGX::renderGlyph(const ftgxGlyph &glyph, int *top) {
+	FT_Face face = glyph.face->ftFace;
+
+	if(glyph.charData == NULL || FT_Load_Glyph(face, glyph.charData->glyphIndex, FT_LOAD_DEFAULT | FT_LOAD_FORCE_AUTOHINT | FT_LOAD_RENDER) != 0)
+		return NULL;
+
+	if(face->glyph->format != FT_GLYPH_FORMAT_BITMAP || face->glyph->bitmap.pixel_mode != FT_PIXEL_MODE_GRAY)
+		return NULL;
+
+	*top = face->glyph->bitmap_top;
+
+	return &face->glyph->bitmap;
+}
+
 /**
  * Copies the supplied texture quad to the EFB.
  *
@@ -660,10 +791,9 @@ int FreeTypeGX::getHeight(const wchar_t *text, float scaleY) {
  * @param texHeight	The pixel height of the texture object.
  * @param screenX	The screen X coordinate at which to output the rendered texture.
  * @param screenY	The screen Y coordinate at which to output the rendered texture.
+ * @param color	The RGBA color the texture is modulated with.
  */
-void FreeTypeGX::copyTextureToFramebuffer(GXTexObj *texObj, float texWidth, float texHeight, float screenX, float screenY, float scaleX, float scaleY, float offsetX, float offsetY, float degrees) {
-	unsigned int color = GRRLIB_Settings.color;
-
+void FreeTypeGX::copyTextureToFramebuffer(GXTexObj *texObj, float texWidth, float texHeight, float screenX, float screenY, float scaleX, float scaleY, float offsetX, float offsetY, float degrees, uint32_t color) {
 	// Backup matrix
 	GRRLIB_matrix matrixObject = GRRLIB_GetMatrix();
 
@@ -21,6 +21,17 @@
 
 #include "Metaphrasis.hpp"
 
+#ifndef GEKKO
+#define DCFlushRange(startaddress, len) // Host builds (tools) have no data cache to flush
+#endif
+
+// Texture data is big-endian, converters build whole words and store them in that order
+#if defined(GEKKO) || __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define METAPHRASIS_BE32(x) (x)
+#else
+#define METAPHRASIS_BE32(x) __builtin_bswap32(x)
+#endif
+
 /**
  * Default constructor for the Metaphrasis class.
  */
@@ -49,24 +60,40 @@ Metaphrasis::~Metaphrasis() {
 uint32_t* Metaphrasis::convertBufferToI4(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight) {
 	uint32_t bufferSize = bufferWidth * bufferHeight >> 1;
 	uint32_t* dataBufferI4 = (uint32_t *)memalign(32, bufferSize);
-	memset(dataBufferI4, 0x00, bufferSize);
 
-	uint32_t *src = (uint32_t *)rgbaBuffer;
-	uint8_t *dst = (uint8_t *)dataBufferI4;
+	convertBufferToI4(rgbaBuffer, bufferWidth, bufferHeight, dataBufferI4);
+	DCFlushRange(dataBufferI4, bufferSize);
 
+	return dataBufferI4;
+}
+
+/**
+ * Convert the specified RGBA data buffer into the I4 texture format into an existing buffer
+ *
+ * This routine writes the converted data into a buffer allocated by the caller, without flushing it from the data cache.
+ * Converting a band of whole tile rows at a time allows writing a texture in pieces.
+ *
+ * @param rgbaBuffer	Buffer containing the temporarily rendered RGBA data.
+ * @param bufferWidth	Pixel width of the data buffer.
+ * @param bufferHeight	Pixel height of the data buffer.
+ * @param dataBuffer	Buffer receiving the converted data, large enough for the whole texture.
+ */
+
+void Metaphrasis::convertBufferToI4(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight, uint32_t* dataBuffer) {
+	const uint32_t* __restrict src = rgbaBuffer; // Never overlaps the destination, so rows stay in registers
+	uint32_t* __restrict dst = dataBuffer;
+
+	// One 8x8 tile is eight words, one per row
 	for(uint16_t y = 0; y < bufferHeight; y += 8) {
 		for(uint16_t x = 0; x < bufferWidth; x += 8) {
 			for(uint16_t rows = 0; rows < 8; rows++) {
-				*dst++ = (src[((y + rows) * bufferWidth) + (x + 0)] & 0xf0) | ((src[((y + rows) * bufferWidth) + (x + 1)] & 0xf0) >> 4);
-				*dst++ = (src[((y + rows) * bufferWidth) + (x + 2)] & 0xf0) | ((src[((y + rows) * bufferWidth) + (x + 3)] & 0xf0) >> 4);
-				*dst++ = (src[((y + rows) * bufferWidth) + (x + 4)] & 0xf0) | ((src[((y + rows) * bufferWidth) + (x + 5)] & 0xf0) >> 4);
-				*dst++ = (src[((y + rows) * bufferWidth) + (x + 6)] & 0xf0) | ((src[((y + rows) * bufferWidth) + (x + 7)] & 0xf0) >> 4);
+				const uint32_t *row = &src[((y + rows) * bufferWidth) + x];
+
+				*dst++ = METAPHRASIS_BE32(((row[0] & 0xf0) << 24) | ((row[1] & 0xf0) << 20) | ((row[2] & 0xf0) << 16) | ((row[3] & 0xf0) << 12) |
+					((row[4] & 0xf0) << 8) | ((row[5] & 0xf0) << 4) | (row[6] & 0xf0) | ((row[7] & 0xf0) >> 4));
 			}
 		}
 	}
-	DCFlushRange(dataBufferI4, bufferSize);
-
-	return dataBufferI4;
 }
 
 /**
@@ -83,28 +110,40 @@ uint32_t* Metaphrasis::convertBufferToI4(uint32_t* rgbaBuffer, uint16_t bufferWi
 uint32_t* Metaphrasis::convertBufferToI8(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight) {
 	uint32_t bufferSize = bufferWidth * bufferHeight;
 	uint32_t* dataBufferI8 = (uint32_t *)memalign(32, bufferSize);
-	memset(dataBufferI8, 0x00, bufferSize);
 
-	uint32_t *src = (uint32_t *)rgbaBuffer;
-	uint8_t *dst = (uint8_t *)dataBufferI8;
+	convertBufferToI8(rgbaBuffer, bufferWidth, bufferHeight, dataBufferI8);
+	DCFlushRange(dataBufferI8, bufferSize);
 
+	return dataBufferI8;
+}
+
+/**
+ * Convert the specified RGBA data buffer into the I8 texture format into an existing buffer
+ *
+ * This routine writes the converted data into a buffer allocated by the caller, without flushing it from the data cache.
+ * Converting a band of whole tile rows at a time allows writing a texture in pieces.
+ *
+ * @param rgbaBuffer	Buffer containing the temporarily rendered RGBA data.
+ * @param bufferWidth	Pixel width of the data buffer.
+ * @param bufferHeight	Pixel height of the data buffer.
+ * @param dataBuffer	Buffer receiving the converted data, large enough for the whole texture.
+ */
+
+void Metaphrasis::convertBufferToI8(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight, uint32_t* dataBuffer) {
+	const uint32_t* __restrict src = rgbaBuffer; // Never overlaps the destination, so rows stay in registers
+	uint32_t* __restrict dst = dataBuffer;
+
+	// One 8x4 tile is eight words, two per row
 	for(uint16_t y = 0; y < bufferHeight; y += 4) {
 		for(uint16_t x = 0; x < bufferWidth; x += 8) {
 			for(uint16_t rows = 0; rows < 4; rows++) {
-				*dst++ = src[((y + rows) * bufferWidth) + (x + 0)] & 0xff;
-				*dst++ = src[((y + rows) * bufferWidth) + (x + 1)] & 0xff;
-				*dst++ = src[((y + rows) * bufferWidth) + (x + 2)] & 0xff;
-				*dst++ = src[((y + rows) * bufferWidth) + (x + 3)] & 0xff;
-				*dst++ = src[((y + rows) * bufferWidth) + (x + 4)] & 0xff;
-				*dst++ = src[((y + rows) * bufferWidth) + (x + 5)] & 0xff;
-				*dst++ = src[((y + rows) * bufferWidth) + (x + 6)] & 0xff;
-				*dst++ = src[((y + rows) * bufferWidth) + (x + 7)] & 0xff;
+				const uint32_t *row = &src[((y + rows) * bufferWidth) + x];
+
+				*dst++ = METAPHRASIS_BE32(((row[0] & 0xff) << 24) | ((row[1] & 0xff) << 16) | ((row[2] & 0xff) << 8) | (row[3] & 0xff));
+				*dst++ = METAPHRASIS_BE32(((row[4] & 0xff) << 24) | ((row[5] & 0xff) << 16) | ((row[6] & 0xff) << 8) | (row[7] & 0xff));
 			}
 		}
 	}
-	DCFlushRange(dataBufferI8, bufferSize);
-
-	return dataBufferI8;
 }
 
 /**
@@ -146,28 +185,40 @@ uint8_t Metaphrasis::convertRGBAToIA4(uint32_t rgba) {
 uint32_t* Metaphrasis::convertBufferToIA4(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight) {
 	uint32_t bufferSize = bufferWidth * bufferHeight;
 	uint32_t* dataBufferIA4 = (uint32_t *)memalign(32, bufferSize);
-	memset(dataBufferIA4, 0x00, bufferSize);
 
-	uint32_t *src = (uint32_t *)rgbaBuffer;
-	uint8_t *dst = (uint8_t *)dataBufferIA4;
+	convertBufferToIA4(rgbaBuffer, bufferWidth, bufferHeight, dataBufferIA4);
+	DCFlushRange(dataBufferIA4, bufferSize);
 
+	return dataBufferIA4;
+}
+
+/**
+ * Convert the specified RGBA data buffer into the IA4 texture format into an existing buffer
+ *
+ * This routine writes the converted data into a buffer allocated by the caller, without flushing it from the data cache.
+ * Converting a band of whole tile rows at a time allows writing a texture in pieces.
+ *
+ * @param rgbaBuffer	Buffer containing the temporarily rendered RGBA data.
+ * @param bufferWidth	Pixel width of the data buffer.
+ * @param bufferHeight	Pixel height of the data buffer.
+ * @param dataBuffer	Buffer receiving the converted data, large enough for the whole texture.
+ */
+
+void Metaphrasis::convertBufferToIA4(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight, uint32_t* dataBuffer) {
+	const uint32_t* __restrict src = rgbaBuffer; // Never overlaps the destination, so rows stay in registers
+	uint32_t* __restrict dst = dataBuffer;
+
+	// One 8x4 tile is eight words, two per row
 	for(uint16_t y = 0; y < bufferHeight; y += 4) {
 		for(uint16_t x = 0; x < bufferWidth; x += 8) {
 			for(uint16_t rows = 0; rows < 4; rows++) {
-				*dst++ = RGBA_TO_IA4(src[((y + rows) * bufferWidth) + (x + 0)]);
-				*dst++ = RGBA_TO_IA4(src[((y + rows) * bufferWidth) + (x + 1)]);
-				*dst++ = RGBA_TO_IA4(src[((y + rows) * bufferWidth) + (x + 2)]);
-				*dst++ = RGBA_TO_IA4(src[((y + rows) * bufferWidth) + (x + 3)]);
-				*dst++ = RGBA_TO_IA4(src[((y + rows) * bufferWidth) + (x + 4)]);
-				*dst++ = RGBA_TO_IA4(src[((y + rows) * bufferWidth) + (x + 5)]);
-				*dst++ = RGBA_TO_IA4(src[((y + rows) * bufferWidth) + (x + 6)]);
-				*dst++ = RGBA_TO_IA4(src[((y + rows) * bufferWidth) + (x + 7)]);
+				const uint32_t *row = &src[((y + rows) * bufferWidth) + x];
+
+				*dst++ = METAPHRASIS_BE32(((RGBA_TO_IA4(row[0])) << 24) | ((RGBA_TO_IA4(row[1])) << 16) | ((RGBA_TO_IA4(row[2])) << 8) | (RGBA_TO_IA4(row[3])));
+				*dst++ = METAPHRASIS_BE32(((RGBA_TO_IA4(row[4])) << 24) | ((RGBA_TO_IA4(row[5])) << 16) | ((RGBA_TO_IA4(row[6])) << 8) | (RGBA_TO_IA4(row[7])));
 			}
 		}
 	}
-	DCFlushRange(dataBufferIA4, bufferSize);
-
-	return dataBufferIA4;
 }
 
 /**
@@ -210,24 +261,40 @@ uint16_t Metaphrasis::convertRGBAToIA8(uint32_t rgba) {
 uint32_t* Metaphrasis::convertBufferToIA8(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight) {
 	uint32_t bufferSize = (bufferWidth * bufferHeight) << 1;
 	uint32_t* dataBufferIA8 = (uint32_t *)memalign(32, bufferSize);
-	memset(dataBufferIA8, 0x00, bufferSize);
 
-	uint32_t *src = (uint32_t *)rgbaBuffer;
-	uint16_t *dst = (uint16_t *)dataBufferIA8;
+	convertBufferToIA8(rgbaBuffer, bufferWidth, bufferHeight, dataBufferIA8);
+	DCFlushRange(dataBufferIA8, bufferSize);
 
+	return dataBufferIA8;
+}
+
+/**
+ * Convert the specified RGBA data buffer into the IA8 texture format into an existing buffer
+ *
+ * This routine writes the converted data into a buffer allocated by the caller, without flushing it from the data cache.
+ * Converting a band of whole tile rows at a time allows writing a texture in pieces.
+ *
+ * @param rgbaBuffer	Buffer containing the temporarily rendered RGBA data.
+ * @param bufferWidth	Pixel width of the data buffer.
+ * @param bufferHeight	Pixel height of the data buffer.
+ * @param dataBuffer	Buffer receiving the converted data, large enough for the whole texture.
+ */
+
+void Metaphrasis::convertBufferToIA8(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight, uint32_t* dataBuffer) {
+	const uint32_t* __restrict src = rgbaBuffer; // Never overlaps the destination, so rows stay in registers
+	uint32_t* __restrict dst = dataBuffer;
+
+	// One 4x4 tile is eight words, two texels per word
 	for(uint16_t y = 0; y < bufferHeight; y += 4) {
 		for(uint16_t x = 0; x < bufferWidth; x += 4) {
 			for(uint16_t rows = 0; rows < 4; rows++) {
-				*dst++ = RGBA_TO_IA8(src[((y + rows) * bufferWidth) + (x + 0)]);
-				*dst++ = RGBA_TO_IA8(src[((y + rows) * bufferWidth) + (x + 1)]);
-				*dst++ = RGBA_TO_IA8(src[((y + rows) * bufferWidth) + (x + 2)]);
-				*dst++ = RGBA_TO_IA8(src[((y + rows) * bufferWidth) + (x + 3)]);
+				const uint32_t *row = &src[((y + rows) * bufferWidth) + x];
+
+				*dst++ = METAPHRASIS_BE32(((uint32_t)(RGBA_TO_IA8(row[0])) << 16) | (uint16_t)(RGBA_TO_IA8(row[1])));
+				*dst++ = METAPHRASIS_BE32(((uint32_t)(RGBA_TO_IA8(row[2])) << 16) | (uint16_t)(RGBA_TO_IA8(row[3])));
 			}
 		}
 	}
-	DCFlushRange(dataBufferIA8, bufferSize);
-
-	return dataBufferIA8;
 }
 
 /**
@@ -244,44 +311,45 @@ uint32_t* Metaphrasis::convertBufferToIA8(uint32_t* rgbaBuffer, uint16_t bufferW
 uint32_t* Metaphrasis::convertBufferToRGBA8(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight) {
 	uint32_t bufferSize = (bufferWidth * bufferHeight) << 2;
 	uint32_t* dataBufferRGBA8 = (uint32_t *)memalign(32, bufferSize);
-	memset(dataBufferRGBA8, 0x00, bufferSize);
-
-	uint8_t *src = (uint8_t *)rgbaBuffer;
-	uint8_t *dst = (uint8_t *)dataBufferRGBA8;
-
-	for(uint16_t block = 0; block < bufferHeight; block += 4) {
-		for(uint16_t i = 0; i < bufferWidth; i += 4) {
-            for (uint32_t c = 0; c < 4; c++) {
-				uint32_t blockWid = (((block + c) * bufferWidth) + i) << 2 ;
-
-				*dst++ = src[blockWid + 3];  // ar = 0
-				*dst++ = src[blockWid + 0];
-				*dst++ = src[blockWid + 7];  // ar = 1
-				*dst++ = src[blockWid + 4];
-				*dst++ = src[blockWid + 11]; // ar = 2
-				*dst++ = src[blockWid + 8];
-				*dst++ = src[blockWid + 15]; // ar = 3
-				*dst++ = src[blockWid + 12];
-            }
-            for (uint32_t c = 0; c < 4; c++) {
-				uint32_t blockWid = (((block + c) * bufferWidth) + i ) << 2 ;
-
-				*dst++ = src[blockWid + 1];  // gb = 0
-				*dst++ = src[blockWid + 2];
-				*dst++ = src[blockWid + 5];  // gb = 1
-				*dst++ = src[blockWid + 6];
-				*dst++ = src[blockWid + 9];  // gb = 2
-				*dst++ = src[blockWid + 10];
-				*dst++ = src[blockWid + 13]; // gb = 3
-				*dst++ = src[blockWid + 14];
-            }
-		}
-	}
+
+	convertBufferToRGBA8(rgbaBuffer, bufferWidth, bufferHeight, dataBufferRGBA8);
 	DCFlushRange(dataBufferRGBA8, bufferSize);
 
 	return dataBufferRGBA8;
 }
 
+/**
+ * Convert the specified RGBA data buffer into the RGBA8 texture format into an existing buffer
+ *
+ * This routine writes the converted data into a buffer allocated by the caller, without flushing it from the data cache.
+ * Converting a band of whole tile rows at a time allows writing a texture in pieces.
+ *
+ * @param rgbaBuffer	Buffer containing the temporarily rendered RGBA data.
+ * @param bufferWidth	Pixel width of the data buffer.
+ * @param bufferHeight	Pixel height of the data buffer.
+ * @param dataBuffer	Buffer receiving the converted data, large enough for the whole texture.
+ */
+
+void Metaphrasis::convertBufferToRGBA8(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight, uint32_t* dataBuffer) {
+	const uint32_t* __restrict src = rgbaBuffer; // Never overlaps the destination, so rows stay in registers
+	uint32_t* __restrict dst = dataBuffer;
+
+	// One 4x4 tile is sixteen words, the AR pairs of every row followed by the GB pairs
+	for(uint16_t y = 0; y < bufferHeight; y += 4) {
+		for(uint16_t x = 0; x < bufferWidth; x += 4) {
+			for(uint16_t rows = 0; rows < 4; rows++) {
+				const uint32_t *row = &src[((y + rows) * bufferWidth) + x];
+
+				dst[rows * 2] = METAPHRASIS_BE32(((row[0] & 0xff) << 24) | ((row[0] >> 8) & 0xff0000) | ((row[1] & 0xff) << 8) | (row[1] >> 24));
+				dst[rows * 2 + 1] = METAPHRASIS_BE32(((row[2] & 0xff) << 24) | ((row[2] >> 8) & 0xff0000) | ((row[3] & 0xff) << 8) | (row[3] >> 24));
+				dst[rows * 2 + 8] = METAPHRASIS_BE32(((row[0] << 8) & 0xffff0000) | ((row[1] >> 8) & 0xffff));
+				dst[rows * 2 + 9] = METAPHRASIS_BE32(((row[2] << 8) & 0xffff0000) | ((row[3] >> 8) & 0xffff));
+			}
+			dst += 16;
+		}
+	}
+}
+
 /**
  * Downsample the specified RGBA value data buffer to an RGB565 value.
  *
@@ -321,24 +389,40 @@ uint16_t Metaphrasis::convertRGBAToRGB565(uint32_t rgba) {
 uint32_t* Metaphrasis::convertBufferToRGB565(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight) {
 	uint32_t bufferSize = (bufferWidth * bufferHeight) << 1;
 	uint32_t* dataBufferRGB565 = (uint32_t *)memalign(32, bufferSize);
-	memset(dataBufferRGB565, 0x00, bufferSize);
 
-	uint32_t *src = (uint32_t *)rgbaBuffer;
-	uint16_t *dst = (uint16_t *)dataBufferRGB565;
+	convertBufferToRGB565(rgbaBuffer, bufferWidth, bufferHeight, dataBufferRGB565);
+	DCFlushRange(dataBufferRGB565, bufferSize);
 
+	return dataBufferRGB565;
+}
+
+/**
+ * Convert the specified RGBA data buffer into the RGB565 texture format into an existing buffer
+ *
+ * This routine writes the converted data into a buffer allocated by the caller, without flushing it from the data cache.
+ * Converting a band of whole tile rows at a time allows writing a texture in pieces.
+ *
+ * @param rgbaBuffer	Buffer containing the temporarily rendered RGBA data.
+ * @param bufferWidth	Pixel width of the data buffer.
+ * @param bufferHeight	Pixel height of the data buffer.
+ * @param dataBuffer	Buffer receiving the converted data, large enough for the whole texture.
+ */
+
+void Metaphrasis::convertBufferToRGB565(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight, uint32_t* dataBuffer) {
+	const uint32_t* __restrict src = rgbaBuffer; // Never overlaps the destination, so rows stay in registers
+	uint32_t* __restrict dst = dataBuffer;
+
+	// One 4x4 tile is eight words, two texels per word
 	for(uint16_t y = 0; y < bufferHeight; y += 4) {
 		for(uint16_t x = 0; x < bufferWidth; x += 4) {
 			for(uint16_t rows = 0; rows < 4; rows++) {
-				*dst++ = RGBA_TO_RGB565(src[((y + rows) * bufferWidth) + (x + 0)]);
-				*dst++ = RGBA_TO_RGB565(src[((y + rows) * bufferWidth) + (x + 1)]);
-				*dst++ = RGBA_TO_RGB565(src[((y + rows) * bufferWidth) + (x + 2)]);
-				*dst++ = RGBA_TO_RGB565(src[((y + rows) * bufferWidth) + (x + 3)]);
+				const uint32_t *row = &src[((y + rows) * bufferWidth) + x];
+
+				*dst++ = METAPHRASIS_BE32(((uint32_t)(RGBA_TO_RGB565(row[0])) << 16) | (uint16_t)(RGBA_TO_RGB565(row[1])));
+				*dst++ = METAPHRASIS_BE32(((uint32_t)(RGBA_TO_RGB565(row[2])) << 16) | (uint16_t)(RGBA_TO_RGB565(row[3])));
 			}
 		}
 	}
-	DCFlushRange(dataBufferRGB565, bufferSize);
-
-	return dataBufferRGB565;
 }
 
 /**
@@ -357,7 +441,7 @@ uint32_t* Metaphrasis::convertBufferToRGB565(uint32_t* rgbaBuffer, uint16_t buff
  * \n
  * RGB555 (16bit): [1]r7r6r5r4r3g7g6|g5g4g3b7b6b5b4b3
  * \n
- * RGB444 (16bit): [0]r7r6r5r4g7g6g5|g4b7b6b5b4a7a6a5
+ * RGB444 (16bit): [0]a7a6a5r7r6r5r4|g7g6g5g4b7b6b5b4
  * </code>
  *
  * @param rgba	A 32-bit RGBA value to convert to the RGB5A3 format.
@@ -382,22 +466,368 @@ uint16_t Metaphrasis::convertRGBAToRGB5A3(uint32_t rgba) {
 uint32_t* Metaphrasis::convertBufferToRGB5A3(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight) {
 	uint32_t bufferSize = (bufferWidth * bufferHeight) << 1;
 	uint32_t* dataBufferRGB5A3 = (uint32_t *)memalign(32, bufferSize);
-	memset(dataBufferRGB5A3, 0x00, bufferSize);
 
-	uint32_t *src = (uint32_t *)rgbaBuffer;
-	uint16_t *dst = (uint16_t *)dataBufferRGB5A3;
+	convertBufferToRGB5A3(rgbaBuffer, bufferWidth, bufferHeight, dataBufferRGB5A3);
+	DCFlushRange(dataBufferRGB5A3, bufferSize);
 
+	return dataBufferRGB5A3;
+}
+
+/**
+ * Convert the specified RGBA data buffer into the RGB5A3 texture format into an existing buffer
+ *
+ * This routine writes the converted data into a buffer allocated by the caller, without flushing it from the data cache.
+ * Converting a band of whole tile rows at a time allows writing a texture in pieces.
+ *
+ * @param rgbaBuffer	Buffer containing the temporarily rendered RGBA data.
+ * @param bufferWidth	Pixel width of the data buffer.
+ * @param bufferHeight	Pixel height of the data buffer.
+ * @param dataBuffer	Buffer receiving the converted data, large enough for the whole texture.
+ */
+
+void Metaphrasis::convertBufferToRGB5A3(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight, uint32_t* dataBuffer) {
+	const uint32_t* __restrict src = rgbaBuffer; // Never overlaps the destination, so rows stay in registers
+	uint32_t* __restrict dst = dataBuffer;
+
+	// One 4x4 tile is eight words, two texels per word
 	for(uint16_t y = 0; y < bufferHeight; y += 4) {
 		for(uint16_t x = 0; x < bufferWidth; x += 4) {
 			for(uint16_t rows = 0; rows < 4; rows++) {
-				*dst++ = RGBA_TO_RGB5A3(src[((y + rows) * bufferWidth) + (x + 0)]);
-				*dst++ = RGBA_TO_RGB5A3(src[((y + rows) * bufferWidth) + (x + 1)]);
-				*dst++ = RGBA_TO_RGB5A3(src[((y + rows) * bufferWidth) + (x + 2)]);
-				*dst++ = RGBA_TO_RGB5A3(src[((y + rows) * bufferWidth) + (x + 3)]);
+				const uint32_t *row = &src[((y + rows) * bufferWidth) + x];
+
+				*dst++ = METAPHRASIS_BE32(((uint32_t)(RGBA_TO_RGB5A3(row[0])) << 16) | (uint16_t)(RGBA_TO_RGB5A3(row[1])));
+				*dst++ = METAPHRASIS_BE32(((uint32_t)(RGBA_TO_RGB5A3(row[2])) << 16) | (uint16_t)(RGBA_TO_RGB5A3(row[3])));
 			}
 		}
 	}
-	DCFlushRange(dataBufferRGB5A3, bufferSize);
+}
 
-	return dataBufferRGB5A3;
+/**
+ * Expand a packed RGB565 value into a 32-bit RGBA value the way the GX texture unit does.
+ *
+ * @param rgb565	A 16-bit RGB565 value.
+ * @return The RGBA value of the given RGB565 value.
+ */
+
+static uint32_t convertRGB565ToRGBA(uint16_t rgb565) {
+	uint32_t r = (rgb565 >> 11) & 0x1f, g = (rgb565 >> 5) & 0x3f, b = rgb565 & 0x1f;
+
+	return (((r << 3) | (r >> 2)) << 24) | (((g << 2) | (g >> 4)) << 16) | (((b << 3) | (b >> 2)) << 8) | 0xff;
+}
+
+/**
+ * Build the four color palette of a CMPR block the way the GX texture unit does.
+ *
+ * @param color0	First endpoint of the block.
+ * @param color1	Second endpoint of the block.
+ * @param palette	Array receiving the four RGBA palette entries.
+ */
+
+static void buildCMPRPalette(uint16_t color0, uint16_t color1, uint32_t* palette) {
+	palette[0] = convertRGB565ToRGBA(color0);
+	palette[1] = convertRGB565ToRGBA(color1);
+
+	if(color0 > color1) {
+		palette[2] = 0xff;
+		palette[3] = 0xff;
+		for(uint8_t shift = 8; shift < 32; shift += 8) {
+			uint32_t c0 = (palette[0] >> shift) & 0xff, c1 = (palette[1] >> shift) & 0xff;
+
+			palette[2] |= ((c0 * 5 + c1 * 3) >> 3) << shift;
+			palette[3] |= ((c0 * 3 + c1 * 5) >> 3) << shift;
+		}
+	}
+	else {
+		palette[2] = 0xff;
+		for(uint8_t shift = 8; shift < 32; shift += 8) {
+			palette[2] |= ((((palette[0] >> shift) & 0xff) + ((palette[1] >> shift) & 0xff)) >> 1) << shift;
+		}
+		palette[3] = 0x00000000;
+	}
+}
+
+/**
+ * Compress a 4x4 block of RGBA values into a CMPR (DXT1) sub-block.
+ *
+ * <strong>Format Explanation</strong>
+ * \n
+ * A CMPR sub-block stores two big-endian RGB565 endpoints followed by one byte of 2-bit palette indices per row,
+ * leftmost pixel in the most significant bits. If the first endpoint is greater than the second the palette holds
+ * the endpoints and two interpolated colors, otherwise it holds the endpoints, their average and a transparent color.
+ * Blocks with any pixel whose alpha is below 0x80 use the transparent palette.
+ * \n\n
+ * Endpoints are chosen along the principal axis of the block's colors.
+ *
+ * @param rgba	Pointer to the top left RGBA value of the block.
+ * @param stride	Pixel width of the buffer holding the block.
+ * @param block	Pointer to the 8 byte destination sub-block.
+ */
+
+void Metaphrasis::convertRGBABlockToCMPR(const uint32_t* rgba, uint16_t stride, uint8_t* block) {
+	float pixels[16][3];
+	bool transparent[16];
+	bool hasAlpha = false;
+	uint8_t opaqueCount = 0;
+	float mean[3] = {0.0f, 0.0f, 0.0f};
+
+	for(uint8_t i = 0; i < 16; i++) {
+		uint32_t color = rgba[(i >> 2) * stride + (i & 3)];
+
+		transparent[i] = (color & 0xff) < 0x80;
+		hasAlpha |= transparent[i];
+
+		pixels[i][0] = (color >> 24) & 0xff;
+		pixels[i][1] = (color >> 16) & 0xff;
+		pixels[i][2] = (color >> 8) & 0xff;
+
+		if(!transparent[i]) {
+			for(uint8_t c = 0; c < 3; c++) mean[c] += pixels[i][c];
+			opaqueCount++;
+		}
+	}
+
+	uint16_t color0 = 0, color1 = 0;
+
+	if(opaqueCount > 0) {
+		float covariance[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+		float minProjection = 1e9f, maxProjection = -1e9f;
+		uint8_t minPixel = 0, maxPixel = 0;
+
+		for(uint8_t c = 0; c < 3; c++) mean[c] /= opaqueCount;
+
+		for(uint8_t i = 0; i < 16; i++) {
+			if(transparent[i]) continue;
+
+			float r = pixels[i][0] - mean[0], g = pixels[i][1] - mean[1], b = pixels[i][2] - mean[2];
+
+			covariance[0] += r * r;
+			covariance[1] += r * g;
+			covariance[2] += r * b;
+			covariance[3] += g * g;
+			covariance[4] += g * b;
+			covariance[5] += b * b;
+		}
+
+		// Start from the covariance column of the channel that varies most. It lies in the span of the colors, so unlike
+		// a fixed axis it can't be orthogonal to the only direction of a two-color block.
+		float axis[3] = {covariance[0], covariance[1], covariance[2]};
+
+		if(covariance[3] > covariance[0] && covariance[3] >= covariance[5]) {
+			axis[0] = covariance[1];
+			axis[1] = covariance[3];
+			axis[2] = covariance[4];
+		}
+		else if(covariance[5] > covariance[0] && covariance[5] > covariance[3]) {
+			axis[0] = covariance[2];
+			axis[1] = covariance[4];
+			axis[2] = covariance[5];
+		}
+
+		// A few power iterations are enough to find the principal axis of 16 colors
+		for(uint8_t iteration = 0; iteration < 4; iteration++) {
+			float x = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+			float y = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+			float z = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+			float length = x * x + y * y + z * z;
+
+			if(length < 1e-6f) break;
+
+			float scale = 1.0f / __builtin_sqrtf(length);
+
+			axis[0] = x * scale;
+			axis[1] = y * scale;
+			axis[2] = z * scale;
+		}
+
+		for(uint8_t i = 0; i < 16; i++) {
+			if(transparent[i]) continue;
+
+			float projection = pixels[i][0] * axis[0] + pixels[i][1] * axis[1] + pixels[i][2] * axis[2];
+
+			if(projection < minProjection) { minProjection = projection; minPixel = i; }
+			if(projection > maxProjection) { maxProjection = projection; maxPixel = i; }
+		}
+
+		uint32_t maxColor = rgba[(maxPixel >> 2) * stride + (maxPixel & 3)];
+		uint32_t minColor = rgba[(minPixel >> 2) * stride + (minPixel & 3)];
+
+		color0 = RGBA_TO_RGB565(maxColor);
+		color1 = RGBA_TO_RGB565(minColor);
+	}
+
+	// Endpoint order selects the palette mode
+	if((hasAlpha && color0 > color1) || (!hasAlpha && color0 < color1)) {
+		uint16_t swap = color0;
+
+		color0 = color1;
+		color1 = swap;
+	}
+
+	uint32_t palette[4];
+	uint8_t paletteSize = (color0 > color1) ? 4 : 3;
+
+	buildCMPRPalette(color0, color1, palette);
+
+	block[0] = color0 >> 8;
+	block[1] = color0 & 0xff;
+	block[2] = color1 >> 8;
+	block[3] = color1 & 0xff;
+
+	for(uint8_t row = 0; row < 4; row++) {
+		uint8_t indices = 0;
+
+		for(uint8_t column = 0; column < 4; column++) {
+			uint8_t i = (row << 2) | column;
+			uint8_t index = 3;
+
+			if(!transparent[i]) {
+				int32_t bestError = 0x7fffffff;
+
+				for(uint8_t p = 0; p < paletteSize; p++) {
+					int32_t r = (int32_t)pixels[i][0] - (int32_t)((palette[p] >> 24) & 0xff);
+					int32_t g = (int32_t)pixels[i][1] - (int32_t)((palette[p] >> 16) & 0xff);
+					int32_t b = (int32_t)pixels[i][2] - (int32_t)((palette[p] >> 8) & 0xff);
+					int32_t error = r * r + g * g + b * b;
+
+					if(error < bestError) {
+						bestError = error;
+						index = p;
+					}
+				}
+			}
+
+			indices |= index << (6 - (column << 1));
+		}
+
+		block[4 + row] = indices;
+	}
+}
+
+/**
+ * Decompress a CMPR (DXT1) sub-block into a 4x4 block of RGBA values.
+ *
+ * @param block	Pointer to the 8 byte source sub-block.
+ * @param rgba	Pointer to the top left RGBA value of the destination block.
+ * @param stride	Pixel width of the buffer holding the block.
+ */
+
+void Metaphrasis::convertCMPRBlockToRGBA(const uint8_t* block, uint32_t* rgba, uint16_t stride) {
+	uint32_t palette[4];
+
+	buildCMPRPalette((block[0] << 8) | block[1], (block[2] << 8) | block[3], palette);
+
+	for(uint8_t row = 0; row < 4; row++) {
+		for(uint8_t column = 0; column < 4; column++) {
+			rgba[row * stride + column] = palette[(block[4 + row] >> (6 - (column << 1))) & 3];
+		}
+	}
+}
+
+/**
+ * Convert the specified RGBA data buffer into the CMPR texture format
+ *
+ * This routine converts the RGBA data buffer into the CMPR texture format and returns a pointer to the converted buffer.
+ * CMPR tiles are 8x8 pixels made of four DXT1 sub-blocks in reading order, so both dimensions must be multiples of 8.
+ *
+ * @param rgbaBuffer	Buffer containing the temporarily rendered RGBA data.
+ * @param bufferWidth	Pixel width of the data buffer.
+ * @param bufferHeight	Pixel height of the data buffer.
+ * @return	A pointer to the allocated buffer.
+ */
+
+uint32_t* Metaphrasis::convertBufferToCMPR(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight) {
+	uint32_t bufferSize = bufferWidth * bufferHeight >> 1;
+	uint32_t* dataBufferCMPR = (uint32_t *)memalign(32, bufferSize);
+
+	convertBufferToCMPR(rgbaBuffer, bufferWidth, bufferHeight, dataBufferCMPR);
+	DCFlushRange(dataBufferCMPR, bufferSize);
+
+	return dataBufferCMPR;
+}
+
+/**
+ * Convert the specified RGBA data buffer into the CMPR texture format into an existing buffer
+ *
+ * This routine writes the converted data into a buffer allocated by the caller, without flushing it from the data cache.
+ * Converting a band of whole tile rows at a time allows writing a texture in pieces.
+ *
+ * @param rgbaBuffer	Buffer containing the temporarily rendered RGBA data.
+ * @param bufferWidth	Pixel width of the data buffer.
+ * @param bufferHeight	Pixel height of the data buffer.
+ * @param dataBuffer	Buffer receiving the converted data, large enough for the whole texture.
+ */
+
+void Metaphrasis::convertBufferToCMPR(uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight, uint32_t* dataBuffer) {
+	uint8_t *dst = (uint8_t *)dataBuffer;
+
+	for(uint16_t y = 0; y < bufferHeight; y += 8) {
+		for(uint16_t x = 0; x < bufferWidth; x += 8) {
+			for(uint16_t block = 0; block < 4; block++) {
+				convertRGBABlockToCMPR(&rgbaBuffer[(y + ((block >> 1) << 2)) * bufferWidth + x + ((block & 1) << 2)], bufferWidth, dst);
+				dst += 8;
+			}
+		}
+	}
+}
+
+/**
+ * Convert the specified CMPR data buffer back into RGBA values
+ *
+ * This routine decodes CMPR texture data into a linear RGBA buffer, mainly to verify the output of the encoder.
+ *
+ * @param cmprBuffer	Buffer containing the CMPR texture data.
+ * @param bufferWidth	Pixel width of the data buffer.
+ * @param bufferHeight	Pixel height of the data buffer.
+ * @return	A pointer to the allocated buffer.
+ */
+
+uint32_t* Metaphrasis::convertCMPRToBuffer(const uint8_t* cmprBuffer, uint16_t bufferWidth, uint16_t bufferHeight) {
+	uint32_t* rgbaBuffer = (uint32_t *)memalign(32, (bufferWidth * bufferHeight) << 2);
+
+	for(uint16_t y = 0; y < bufferHeight; y += 8) {
+		for(uint16_t x = 0; x < bufferWidth; x += 8) {
+			for(uint16_t block = 0; block < 4; block++) {
+				convertCMPRBlockToRGBA(cmprBuffer, &rgbaBuffer[(y + ((block >> 1) << 2)) * bufferWidth + x + ((block & 1) << 2)], bufferWidth);
+				cmprBuffer += 8;
+			}
+		}
+	}
+
+	return rgbaBuffer;
+}
+
+/**
+ * Downsample the specified RGBA data buffer to half its size for the next mipmap level
+ *
+ * This routine averages every 2x2 block of RGBA values with rounding (a box filter). Odd or single-pixel dimensions
+ * reuse the last row or column. Channels are summed in pairs packed into 32-bit words, so each output value takes a
+ * handful of word operations instead of eight separate channel sums.
+ *
+ * @param rgbaBuffer	Buffer containing the RGBA data of the current level.
+ * @param bufferWidth	Pixel width of the data buffer.
+ * @param bufferHeight	Pixel height of the data buffer.
+ * @param bufferStride	Pixels between the starts of two rows of the data buffer.
+ * @param mipmapBuffer	Buffer receiving the (bufferWidth / 2) x (bufferHeight / 2) RGBA data of the next level, at least 1x1.
+ */
+
+void Metaphrasis::downsampleBuffer(const uint32_t* rgbaBuffer, uint16_t bufferWidth, uint16_t bufferHeight, uint16_t bufferStride, uint32_t* mipmapBuffer) {
+	uint16_t mipmapWidth = bufferWidth > 1 ? bufferWidth >> 1 : 1;
+	uint16_t mipmapHeight = bufferHeight > 1 ? bufferHeight >> 1 : 1;
+	uint16_t nextColumn = bufferWidth > 1 ? 1 : 0;
+	uint32_t nextRow = bufferHeight > 1 ? bufferStride : 0;
+
+	for(uint16_t y = 0; y < mipmapHeight; y++) {
+		const uint32_t* __restrict top = &rgbaBuffer[(y << 1) * bufferStride];
+		const uint32_t* __restrict bottom = top + nextRow;
+
+		for(uint16_t x = 0; x < mipmapWidth; x++) {
+			uint32_t a = top[x << 1], b = top[(x << 1) + nextColumn], c = bottom[x << 1], d = bottom[(x << 1) + nextColumn];
+
+			// Red/blue and green/alpha sums fit in 16-bit lanes (4 * 255 < 65536)
+			uint32_t evenLanes = (a & 0x00ff00ff) + (b & 0x00ff00ff) + (c & 0x00ff00ff) + (d & 0x00ff00ff) + 0x00020002;
+			uint32_t oddLanes = ((a >> 8) & 0x00ff00ff) + ((b >> 8) & 0x00ff00ff) + ((c >> 8) & 0x00ff00ff) + ((d >> 8) & 0x00ff00ff) + 0x00020002;
+
+			*mipmapBuffer++ = ((evenLanes >> 2) & 0x00ff00ff) | (((oddLanes >> 2) & 0x00ff00ff) << 8);
+		}
+	}
 }
@@ -27,14 +27,20 @@
 // Classes
 #include "classes/audio/source.hpp"
 #include "classes/graphics/font.hpp"
+#include "classes/graphics/imagedata.hpp"
+#include "classes/graphics/particlesystem.hpp"
 #include "classes/graphics/quad.hpp"
 #include "classes/graphics/texture.hpp"
+#include "classes/graphics/tilemap.hpp"
+#include "classes/graphics/video.hpp"
+#include "classes/math/transform.hpp"
 
 // Modules
 #include "modules/audio.hpp"
 #include "modules/event.hpp"
 #include "modules/filesystem.hpp"
 #include "modules/graphics.hpp"
+#include "modules/loader.hpp"
 #include "modules/math.hpp"
 #include "modules/system.hpp"
 #include "modules/timer.hpp"
@@ -54,8 +60,14 @@ void init(lua_State *s, int argc, char **argv) {
 	sol::usertype<love::audio::Source> SourceType;
 
 	sol::usertype<love::graphics::Font> FontType;
+	sol::usertype<love::graphics::ImageData> ImageDataType;
+	sol::usertype<love::graphics::ParticleSystem> ParticleSystemType;
 	sol::usertype<love::graphics::Quad> QuadType;
 	sol::usertype<love::graphics::Texture> TextureType;
+	sol::usertype<love::graphics::TileMap> TileMapType;
+	sol::usertype<love::graphics::Video> VideoType;
+
+	sol::usertype<love::math::Transform> TransformType;
 
 	sol::state_view lua(s);
 
@@ -64,6 +76,7 @@ void init(lua_State *s, int argc, char **argv) {
 
 	love::audio::init();
 	love::graphics::init();
+	love::loader::init();
 	love::timer::init();
 
 #if !defined(HW_DOL)
@@ -103,15 +116,21 @@ void init(lua_State *s, int argc, char **argv) {
 			"setBackgroundColor", love::graphics::module::setBackgroundColor,
 			"setColor", love::graphics::module::setColor,
 
+			"applyTransform", love::graphics::module::applyTransform,
 			"origin", love::graphics::module::origin,
 			"pop", love::graphics::module::pop,
 			"push", love::graphics::module::push,
+			"replaceTransform", love::graphics::module::replaceTransform,
 			"scale", love::graphics::module::scale,
 			"rotate", love::graphics::module::rotate,
 			"translate", love::graphics::module::translate,
 
 			"ellipse", love::graphics::module::ellipse,
-			"line", love::graphics::module::line,
+			"line", sol::overload(
+				love::graphics::module::line,
+				love::graphics::module::line1,
+				love::graphics::module::line2
+			),
 			"points", sol::overload(
 				love::graphics::module::points,
 				love::graphics::module::points1,
@@ -124,30 +143,67 @@ void init(lua_State *s, int argc, char **argv) {
 			"rectangle", love::graphics::module::rectangle,
 
 			"getFont", love::graphics::module::getFont,
-			"print", love::graphics::module::print,
+			"print", sol::overload(
+				love::graphics::module::print,
+				love::graphics::module::print1
+			),
 			"setFont", love::graphics::module::setFont,
 
-			"draw", love::graphics::module::draw,
+			"newAtlas", love::graphics::module::newAtlas,
+
+			"draw", sol::overload(
+				love::graphics::module::draw,
+				love::graphics::module::drawParticles,
+				love::graphics::module::drawTileMap,
+				love::graphics::module::drawVideo
+			),
 			"drawQuad", love::graphics::module::drawQuad,
 
 			"getAntiAliasing", love::graphics::module::getAntiAliasing,
 			"getDeflicker", love::graphics::module::getDeflicker,
+			"getFrameLimit", love::graphics::module::getFrameLimit,
+			"getLineJoin", love::graphics::module::getLineJoin,
 			"getLineWidth", love::graphics::module::getLineWidth,
 			"getPointSize", love::graphics::module::getPointSize,
+			"getPresentMode", love::graphics::module::getPresentMode,
 			"getScissor", love::graphics::module::getScissor,
+			"getStats", love::graphics::module::getStats,
+			"getTextureCacheBudget", love::graphics::module::getTextureCacheBudget,
+			"getTextureResidency", love::graphics::module::getTextureResidency,
+			"getVertexFormat", love::graphics::module::getVertexFormat,
+			"getVSync", love::graphics::module::getVSync,
 			"reset", love::graphics::module::reset,
 			"setAntiAliasing", love::graphics::module::setAntiAliasing,
 			"setDeflicker", love::graphics::module::setDeflicker,
+			"setFrameLimit", love::graphics::module::setFrameLimit,
+			"setLineJoin", love::graphics::module::setLineJoin,
 			"setLineWidth", love::graphics::module::setLineWidth,
 			"setPointSize", love::graphics::module::setPointSize,
+			"setPresentMode", love::graphics::module::setPresentMode,
 			"setScissor", sol::overload(
 				love::graphics::module::setScissor,
 				love::graphics::module::setScissor1
 			),
-
+			"setTextureCacheBudget", love::graphics::module::setTextureCacheBudget,
+			"setTextureResidency", love::graphics::module::setTextureResidency,
+			"setVertexFormat", love::graphics::module::setVertexFormat,
+			"setVSync", love::graphics::module::setVSync,
+
+			"captureScreenshot", sol::overload(
+				love::graphics::module::captureScreenshot,
+				love::graphics::module::captureScreenshot1
+			),
 			"present", love::graphics::module::present
 		),
 
+		"loader", lua.create_table_with(
+			"newFont", love::loader::module::newFont,
+			"newTexture", love::loader::module::newTexture,
+
+			"cancel", love::loader::module::cancel,
+			"getPendingCount", love::loader::module::getPendingCount
+		),
+
 		"math", lua.create_table_with(
 			"random", sol::overload(
 				love::math::module::random,
@@ -222,12 +278,98 @@ void init(lua_State *s, int argc, char **argv) {
 			love::graphics::Font(unsigned int),
 			love::graphics::Font(),
 			love::graphics::Font(const char *, unsigned int),
-			love::graphics::Font(const char *)
+			love::graphics::Font(const char *),
+			love::graphics::Font(const char *, const std::wstring &, int)
 		>(),
 
+		"setFallbacks", &love::graphics::Font::setFallbacks,
+		"bake", sol::overload(
+			&love::graphics::Font::bake,
+			&love::graphics::Font::bake1,
+			&love::graphics::Font::bake2,
+			&love::graphics::Font::bake3
+		),
+
 		"clone", &love::graphics::Font::clone,
 		"release", &love::graphics::Font::release
 	);
+	ImageDataType = lua.new_usertype<love::graphics::ImageData>(
+		"_ImageData", sol::constructors<
+			love::graphics::ImageData(unsigned int, unsigned int, const std::string &),
+			love::graphics::ImageData(const love::graphics::Texture &)
+		>(),
+
+		"getWidth", &love::graphics::ImageData::getWidth,
+		"getHeight", &love::graphics::ImageData::getHeight,
+		"getDimensions", &love::graphics::ImageData::getDimensions,
+		"getFormat", &love::graphics::ImageData::getFormat,
+
+		"getPixel", &love::graphics::ImageData::getPixel,
+		"setPixel", &love::graphics::ImageData::setPixel,
+		"mapPixel", sol::overload(
+			&love::graphics::ImageData::mapPixel,
+			&love::graphics::ImageData::mapPixel1
+		),
+
+		"clone", &love::graphics::ImageData::clone,
+		"release", &love::graphics::ImageData::release
+	);
+	ParticleSystemType = lua.new_usertype<love::graphics::ParticleSystem>(
+		"_ParticleSystem", sol::constructors<
+			love::graphics::ParticleSystem(const love::graphics::Texture &, unsigned int)
+		>(),
+
+		"emit", &love::graphics::ParticleSystem::emit,
+		"reset", &love::graphics::ParticleSystem::reset,
+		"start", &love::graphics::ParticleSystem::start,
+		"stop", &love::graphics::ParticleSystem::stop,
+		"update", &love::graphics::ParticleSystem::update,
+
+		"getBufferSize", &love::graphics::ParticleSystem::getBufferSize,
+		"getCount", &love::graphics::ParticleSystem::getCount,
+		"isActive", &love::graphics::ParticleSystem::isActive,
+
+		"getDirection", &love::graphics::ParticleSystem::getDirection,
+		"getEmissionRate", &love::graphics::ParticleSystem::getEmissionRate,
+		"getEmitterLifetime", &love::graphics::ParticleSystem::getEmitterLifetime,
+		"getLinearAcceleration", &love::graphics::ParticleSystem::getLinearAcceleration,
+		"getParticleLifetime", &love::graphics::ParticleSystem::getParticleLifetime,
+		"getPosition", &love::graphics::ParticleSystem::getPosition,
+		"getRotation", &love::graphics::ParticleSystem::getRotation,
+		"getSpeed", &love::graphics::ParticleSystem::getSpeed,
+		"getSpin", &love::graphics::ParticleSystem::getSpin,
+		"getSpread", &love::graphics::ParticleSystem::getSpread,
+		"getTexture", &love::graphics::ParticleSystem::getTexture,
+		"setColors", &love::graphics::ParticleSystem::setColors,
+		"setDirection", &love::graphics::ParticleSystem::setDirection,
+		"setEmissionRate", &love::graphics::ParticleSystem::setEmissionRate,
+		"setEmitterLifetime", &love::graphics::ParticleSystem::setEmitterLifetime,
+		"setLinearAcceleration", &love::graphics::ParticleSystem::setLinearAcceleration,
+		"setParticleLifetime", sol::overload(
+			&love::graphics::ParticleSystem::setParticleLifetime,
+			&love::graphics::ParticleSystem::setParticleLifetime1
+		),
+		"setPosition", &love::graphics::ParticleSystem::setPosition,
+		"setQuads", &love::graphics::ParticleSystem::setQuads,
+		"setRotation", sol::overload(
+			&love::graphics::ParticleSystem::setRotation,
+			&love::graphics::ParticleSystem::setRotation1
+		),
+		"setSizes", &love::graphics::ParticleSystem::setSizes,
+		"setSpeed", sol::overload(
+			&love::graphics::ParticleSystem::setSpeed,
+			&love::graphics::ParticleSystem::setSpeed1
+		),
+		"setSpin", sol::overload(
+			&love::graphics::ParticleSystem::setSpin,
+			&love::graphics::ParticleSystem::setSpin1
+		),
+		"setSpread", &love::graphics::ParticleSystem::setSpread,
+
+		"clone", &love::graphics::ParticleSystem::clone,
+		"release", &love::graphics::ParticleSystem::release
+	);
+
 	QuadType = lua.new_usertype<love::graphics::Quad>(
 		"_Quad", sol::constructors<
 			love::graphics::Quad(float, float, float, float, unsigned int, unsigned int),
@@ -241,15 +383,87 @@ void init(lua_State *s, int argc, char **argv) {
 		"release", &love::graphics::Quad::release
 	);
 	TextureType = lua.new_usertype<love::graphics::Texture>(
-		"_Texture", sol::constructors<love::graphics::Texture(const char *)>(),
+		"_Texture", sol::constructors<
+			love::graphics::Texture(const char *),
+			love::graphics::Texture(const char *, const std::string &),
+			love::graphics::Texture(const char *, const std::string &, bool),
+			love::graphics::Texture(const char *, const std::string &, bool, bool),
+			love::graphics::Texture(const love::graphics::ImageData &)
+		>(),
 
 		"getWidth", &love::graphics::Texture::getWidth,
 		"getHeight", &love::graphics::Texture::getHeight,
 		"getDimensions", &love::graphics::Texture::getDimensions,
+		"getFormat", &love::graphics::Texture::getFormat,
+
+		"replacePixels", sol::overload(
+			sol::resolve<void(const love::graphics::ImageData &)>(&love::graphics::Texture::replacePixels),
+			sol::resolve<void(const love::graphics::ImageData &, unsigned int, unsigned int, unsigned int, unsigned int)>(&love::graphics::Texture::replacePixels)
+		),
 
 		"clone", &love::graphics::Texture::clone,
 		"release", &love::graphics::Texture::release
 	);
+	TileMapType = lua.new_usertype<love::graphics::TileMap>(
+		"_TileMap", sol::constructors<
+			love::graphics::TileMap(const love::graphics::Texture &, unsigned int, unsigned int, unsigned int, unsigned int)
+		>(),
+
+		"getDimensions", &love::graphics::TileMap::getDimensions,
+		"getTileDimensions", &love::graphics::TileMap::getTileDimensions,
+		"getTile", &love::graphics::TileMap::getTile,
+		"getTileRemap", &love::graphics::TileMap::getTileRemap,
+		"setTile", &love::graphics::TileMap::setTile,
+		"setTileRemap", &love::graphics::TileMap::setTileRemap,
+
+		"clone", &love::graphics::TileMap::clone,
+		"release", &love::graphics::TileMap::release
+	);
+	VideoType = lua.new_usertype<love::graphics::Video>(
+		"_Video", sol::constructors<
+			love::graphics::Video(const char *, double)
+		>(),
+
+		"getWidth", &love::graphics::Video::getWidth,
+		"getHeight", &love::graphics::Video::getHeight,
+		"getDimensions", &love::graphics::Video::getDimensions,
+		"getDroppedFrames", &love::graphics::Video::getDroppedFrames,
+		"getFPS", &love::graphics::Video::getFPS,
+		"getSource", &love::graphics::Video::getSource,
+		"getTexture", &love::graphics::Video::getTexture,
+		"isPlaying", &love::graphics::Video::isPlaying,
+		"setSource", &love::graphics::Video::setSource,
+
+		"pause", &love::graphics::Video::pause,
+		"play", &love::graphics::Video::play,
+		"rewind", &love::graphics::Video::rewind,
+		"seek", &love::graphics::Video::seek,
+		"tell", &love::graphics::Video::tell,
+
+		"clone", &love::graphics::Video::clone,
+		"release", &love::graphics::Video::release
+	);
+
+	TransformType = lua.new_usertype<love::math::Transform>(
+		"_Transform", sol::constructors<
+			love::math::Transform(),
+			love::math::Transform(float, float, float, float, float, float, float)
+		>(),
+
+		"apply", &love::math::Transform::apply,
+		"reset", &love::math::Transform::reset,
+		"rotate", &love::math::Transform::rotate,
+		"scale", &love::math::Transform::scale,
+		"setTransformation", &love::math::Transform::setTransformation,
+		"translate", &love::math::Transform::translate,
+
+		"inverse", &love::math::Transform::inverse,
+		"inverseTransformPoint", &love::math::Transform::inverseTransformPoint,
+		"transformPoint", &love::math::Transform::transformPoint,
+
+		"clone", &love::math::Transform::clone,
+		"release", &love::math::Transform::release
+	);
 
 	// Lua-based API
 	lua.require_script("love", std::string(love_lua, love_lua + love_lua_size), false, "WiiLÖVE Lua API", sol::load_mode::text);
@@ -257,6 +471,8 @@ void init(lua_State *s, int argc, char **argv) {
 
 // Perform pre-exit tasks
 void quit() {
+	love::graphics::waitForPresent(); // Don't exit with a frame still in flight
+
 	// Be a good boy, clear the memory allocated by GRRLIB
 	GRRLIB_Exit();
 }
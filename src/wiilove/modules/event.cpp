@@ -31,6 +31,7 @@
 
 // Modules
 #include "love.hpp"
+#include "loader.hpp"
 #include "wiimote.hpp"
 
 // Header
@@ -62,7 +63,7 @@ void init () {
 #endif // !HW_DOL
 }
 
-void pushEvent(lua_State *s, const char *eventName, sol::object value1 = sol::lua_nil, sol::object value2 = sol::lua_nil, sol::object value3 = sol::lua_nil, sol::object value4 = sol::lua_nil, sol::object value5 = sol::lua_nil, sol::object value6 = sol::lua_nil) {
+void pushEvent(lua_State *s, const char *eventName, sol::object value1, sol::object value2, sol::object value3, sol::object value4, sol::object value5, sol::object value6) {
 	events.push_back(std::make_tuple(sol::make_object(s, eventName), value1, value2, value3, value4, value5, value6));
 }
 
@@ -105,6 +106,9 @@ void pump(sol::this_state s) {
 		pushEvent(s, "homepressed", sol::make_object(s, homePressed));
 	}
 
+	// Deliver finished async loads
+	love::loader::update(s);
+
 	it = events.begin();
 }
 values poll() {
@@ -32,6 +32,8 @@ typedef std::tuple<sol::object, sol::object, sol::object, sol::object, sol::obje
 
 void init();
 
+void pushEvent(lua_State *s, const char *eventName, sol::object value1 = sol::lua_nil, sol::object value2 = sol::lua_nil, sol::object value3 = sol::lua_nil, sol::object value4 = sol::lua_nil, sol::object value5 = sol::lua_nil, sol::object value6 = sol::lua_nil);
+
 namespace module {
 
 void pump(sol::this_state s);
@@ -26,6 +26,7 @@
 #include <filesystem>
 #include <fstream>
 #include <cstdlib>
+#include <stdexcept>
 
 // Header
 #include "filesystem.hpp"
@@ -83,13 +84,21 @@ std::string getFilePath(const std::string &filename) { // Get the path of a file
 void getFileData(const char *filename, void *&data, int &size) {
 	std::string filePath = getFilePath(filename);
 
-	std::ifstream file(filePath, std::ios::binary | std::ios::ate); // TODO: Add error handling
+	std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+
+	if (!file.is_open()) { throw std::runtime_error("Could not open " + std::string(filename)); }
 
 	size = file.tellg();
-	data = std::malloc(size);
+	data = std::malloc(size > 0 ? size : 1);
 
 	file.seekg(0, std::ios::beg);
-	file.read(static_cast<char *>(data), size);
+
+	if (size < 0 || !file.read(static_cast<char *>(data), size)) {
+		std::free(data);
+		data = nullptr;
+
+		throw std::runtime_error("Could not read " + std::string(filename));
+	}
 }
 
 namespace module {
@@ -31,7 +31,7 @@ namespace filesystem {
 void init(int argc, char **argv);
 
 std::string getFilePath(const std::string &filename);
-void getFileData(const char *filename, void *&data, int &size);
+void getFileData(const char *filename, void *&data, int &size); // Throws if the file can't be read, data is malloc'd
 
 namespace module {
 
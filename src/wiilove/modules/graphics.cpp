@@ -26,16 +26,34 @@
 #if !defined(HW_DOL)
 #include <ogc/conf.h>
 #endif // !HW_DOL
+#include <ogc/lwp_watchdog.h>
+#include <malloc.h>
+#include <unistd.h>
 #include <utility>
+#include <array>
 #include <vector>
 #include <tuple>
 #include <string>
+#include <map>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <stdexcept>
 
 // Classes
 #include "../classes/graphics/font.hpp"
+#include "../classes/graphics/imagedata.hpp"
+#include "../classes/graphics/particlesystem.hpp"
 #include "../classes/graphics/quad.hpp"
 #include "../classes/graphics/texture.hpp"
+#include "../classes/graphics/tilemap.hpp"
+#include "../classes/graphics/video.hpp"
+#include "../classes/math/transform.hpp"
+
+// Modules
+#include "filesystem.hpp"
+#include "loader.hpp"
 
 // Header
 #include "graphics.hpp"
@@ -50,12 +68,741 @@ namespace {
 
 	bool widescreen;
 
-	// Transforms are stored for push/pop operations
-	std::vector<GRRLIB_matrix> transforms;
+	// Transforms are stored for push/pop operations (preallocated so pushing never allocates mid-frame)
+	constexpr unsigned int maxStackDepth = 64;
+	std::array<GRRLIB_matrix, maxStackDepth> transforms;
+	unsigned int stackDepth = 0;
 
 	unsigned int backgroundColor;
 
 	Font *curFont; // Initial font
+
+	// Visible area, kept in sync with the GRRLIB scissor for culling
+	unsigned int scissorX, scissorY, scissorWidth, scissorHeight;
+
+	// Per-frame statistics, reset on present
+	struct {
+		unsigned int drawCalls;
+		unsigned int culledDraws;
+		unsigned int vertexBytes;
+	} stats;
+
+	unsigned int textureMemory = 0; // Bytes used by all live textures
+
+	// Sprite batching: textured quads sharing a texture are collected in screen space and submitted together
+	struct BatchVertex {
+		float x, y;
+		float u, v;
+		unsigned int color;
+	};
+	std::vector<BatchVertex> batch;
+	std::vector<unsigned char> batchColorIndices;
+	const GRRLIB_texture *batchTexture = nullptr;
+	unsigned char batchFormat;
+	unsigned char batchMaxLOD;
+
+	constexpr unsigned int maxBatchVertices = 65532; // GX_Begin takes a 16-bit vertex count
+
+	// Vertex formats for batches
+	enum class VertexFormat {
+		compact, // s16 positions, u16 texture coordinates, 8-bit color indices when possible (9-12 bytes)
+		full // f32 positions and texture coordinates, like GRRLIB (24 bytes)
+	};
+	std::map<std::string, VertexFormat> vertexFormatMap = {
+		{"compact", VertexFormat::compact},
+		{"float", VertexFormat::full}
+	};
+	VertexFormat vertexFormat = VertexFormat::compact;
+
+	constexpr unsigned char compactVertexFormat = GX_VTXFMT1; // GRRLIB only uses GX_VTXFMT0
+	constexpr int positionFraction = 4;
+	constexpr float positionScale = 1 << positionFraction;
+	constexpr float positionLimit = 32767.0f / positionScale;
+	constexpr int texCoordFraction = 15;
+	constexpr float texCoordScale = 1 << texCoordFraction;
+
+	// Color palettes of indexed batches have to live until the frame is drawn, so they are only reset on present.
+	// With asynchronous presents the GPU can still be drawing the previous frame, so there's one arena per frame.
+	constexpr unsigned int paletteSize = 4096;
+	unsigned int palettes[2][paletteSize] __attribute__((aligned(32)));
+	unsigned int *palette = palettes[0];
+	unsigned int paletteUsed = 0;
+
+	// Buffers replaced while building a frame, freed at the following present. By then both that frame and, with
+	// asynchronous presents, the one still drawing when they were replaced are done.
+	std::vector<void *> retiredBuffers[2];
+	unsigned int retiring = 0;
+
+	unsigned int presentCount = 0; // Frames presented so far, wraps
+
+	// Presenting: "sync" waits for GX and the vertical retrace (see vsync) like GRRLIB_Render, "async" queues the frame
+	// into one of three external framebuffers and returns, blocking only while a previous frame is still queued
+	enum class PresentMode {
+		sync,
+		async
+	};
+	std::map<std::string, PresentMode> presentModeMap = {
+		{"sync", PresentMode::sync},
+		{"async", PresentMode::async}
+	};
+	PresentMode presentMode = PresentMode::sync;
+
+	// Vertical sync: "off" shows the newest finished frame at each retrace without waiting for it, "adaptive" only
+	// waits for the retrace while frames are on time
+	enum class VSync {
+		on,
+		off,
+		adaptive
+	};
+	std::map<std::string, VSync> vsyncMap = {
+		{"on", VSync::on},
+		{"off", VSync::off},
+		{"adaptive", VSync::adaptive}
+	};
+	VSync vsync = VSync::on;
+
+	// Frame limiter
+	double frameLimit = 0.0; // Frames per second, 0 for none
+	unsigned long long frameInterval = 0; // Ticks
+	unsigned long long nextFrameTime = 0;
+	constexpr unsigned long long frameSpinTime = millisecs_to_ticks(2); // Sleeping is only accurate to the scheduler tick
+
+	unsigned int presentRetraceCount = 0; // Retrace count when the last present returned
+	unsigned int missedVBlanks = 0;
+
+	// Screenshots requested this frame, copied out of the EFB on present
+	std::vector<std::string> screenshotFiles;
+	std::vector<sol::protected_function> screenshotCallbacks;
+
+	constexpr int noFramebuffer = -1;
+	void *framebuffers[3] = {nullptr, nullptr, nullptr};
+	lwpq_t presentQueue;
+	VIRetraceCallback nextRetraceCallback = nullptr;
+
+	// Shared with the interrupt handlers below
+	volatile int drawingFramebuffer = noFramebuffer; // Copy queued, GX not done yet
+	volatile int queuedFramebuffer = noFramebuffer; // Done, shown from the next retrace
+	volatile int waitingFramebuffer = noFramebuffer; // Done, queued once queuedFramebuffer is shown
+	volatile bool drawingInOrder = false; // With vsync the drawing frame waits its turn instead of replacing the queued one
+	volatile int shownFramebuffer = noFramebuffer;
+	volatile unsigned short presentToken = 0;
+	volatile unsigned long long presentTime = 0;
+	volatile double frameLatency = 0.0; // Milliseconds from present to GX finishing the frame
+	volatile unsigned int framesDrawn = 0;
+	volatile unsigned long long retraceTime = 0;
+	volatile unsigned long long retracePeriod = millisecs_to_ticks(16); // Measured, 50 or 60 Hz
+	double presentWait = 0.0; // Milliseconds the last present blocked for
+
+	void queueFramebuffer(int framebuffer) {
+		queuedFramebuffer = framebuffer;
+
+		VIDEO_SetNextFramebuffer(framebuffers[framebuffer]);
+		VIDEO_Flush();
+	}
+
+	void presentDrawn(u16 token) { // GX reached the draw sync token after the copy
+		if (drawingFramebuffer == noFramebuffer || token != presentToken) return;
+
+		if (drawingInOrder && queuedFramebuffer != noFramebuffer) {
+			waitingFramebuffer = drawingFramebuffer;
+		} else {
+			waitingFramebuffer = noFramebuffer;
+			queueFramebuffer(drawingFramebuffer);
+		}
+
+		drawingFramebuffer = noFramebuffer;
+
+		frameLatency = static_cast<double>(gettime() - presentTime) / static_cast<double>(TB_TIMER_CLOCK);
+		framesDrawn = framesDrawn + 1;
+
+		LWP_ThreadBroadcast(presentQueue);
+	}
+	void presentRetrace(u32 retraceCount) {
+		unsigned long long now = gettime();
+		void *current = VIDEO_GetCurrentFramebuffer();
+
+		if (retraceTime != 0) retracePeriod = now - retraceTime;
+		retraceTime = now;
+
+		// Without vsync a queued frame can be replaced before it's shown, so look up what the VI actually latched
+		shownFramebuffer = noFramebuffer;
+		for (int i = 0; i < 3; i++) {
+			if (framebuffers[i] != nullptr && framebuffers[i] == current) shownFramebuffer = i;
+		}
+
+		if (queuedFramebuffer != noFramebuffer && queuedFramebuffer == shownFramebuffer) {
+			queuedFramebuffer = noFramebuffer;
+
+			if (waitingFramebuffer != noFramebuffer) { // Next in line, shown from the following retrace
+				queueFramebuffer(waitingFramebuffer);
+				waitingFramebuffer = noFramebuffer;
+			}
+
+			LWP_ThreadBroadcast(presentQueue);
+		}
+
+		if (nextRetraceCallback != nullptr) nextRetraceCallback(retraceCount);
+	}
+
+	// How far asynchronous frames have to get before a wait returns
+	enum class FrameWait {
+		drawn, // GX is done with them
+		room, // Also none waits behind the queued one, so a framebuffer is free
+		shown // Also none is waiting for the retrace
+	};
+
+	void waitForFramebuffers(FrameWait until) {
+		unsigned int level;
+
+		_CPU_ISR_Disable(level);
+		while (drawingFramebuffer != noFramebuffer ||
+			(until != FrameWait::drawn && waitingFramebuffer != noFramebuffer) ||
+			(until == FrameWait::shown && queuedFramebuffer != noFramebuffer)) {
+			LWP_ThreadSleep(presentQueue);
+		}
+		_CPU_ISR_Restore(level);
+	}
+
+	void allocateFramebuffers() { // Allocated once, like GRRLIB's own
+		if (framebuffers[0] != nullptr) return;
+
+		for (void *&framebuffer : framebuffers) {
+			framebuffer = MEM_K0_TO_K1(SYS_AllocateFramebuffer(rmode));
+
+			VIDEO_ClearFrameBuffer(rmode, framebuffer, COLOR_BLACK);
+		}
+	}
+
+	// Copies the frame into the framebuffer that isn't shown or queued, GX shows it once done (see presentDrawn). In
+	// order, it goes behind a frame still waiting for the retrace rather than replacing it.
+	void submitFrame(bool inOrder) {
+		int next = 0;
+
+		while (next == shownFramebuffer || next == queuedFramebuffer) next++;
+
+		// Same end of frame as GRRLIB_Render, minus the waits
+		GX_SetZMode(GX_TRUE, GX_LEQUAL, GX_TRUE);
+		GX_SetColorUpdate(GX_TRUE);
+		GX_CopyDisp(framebuffers[next], GX_TRUE);
+		GX_InvalidateTexAll();
+
+		presentTime = gettime();
+		presentToken = presentToken + 1;
+		drawingInOrder = inOrder;
+		drawingFramebuffer = next;
+
+		GX_SetDrawSync(presentToken);
+		GX_Flush();
+	}
+
+	// Sleeps until the next frame is due, then spins for the last stretch to get sub-millisecond accuracy
+	void limitFrameRate() {
+		if (frameInterval == 0) return;
+
+		unsigned long long now = gettime();
+
+		if (now >= nextFrameTime) { // Late, don't try to catch up with a burst of frames
+			nextFrameTime = now - nextFrameTime > frameInterval ? now + frameInterval : nextFrameTime + frameInterval;
+
+			return;
+		}
+
+		if (nextFrameTime - now > frameSpinTime) usleep(ticks_to_microsecs(nextFrameTime - now - frameSpinTime));
+		while (gettime() < nextFrameTime);
+
+		nextFrameTime += frameInterval;
+	}
+
+	// Queues a copy of the finished frame into RGBA8 tiles, the same layout ImageData uses for "rgba8"
+	unsigned char *copyScreenshot(unsigned int &width, unsigned int &height, unsigned int &size) {
+		width = rmode->fbWidth;
+		height = rmode->efbHeight;
+		size = GX_GetTexBufferSize(width, height, GX_TF_RGBA8, GX_FALSE, 0);
+
+		unsigned char *pixels = static_cast<unsigned char *>(memalign(32, size));
+
+		DCInvalidateRange(pixels, size);
+
+		GX_SetTexCopySrc(0, 0, width, height);
+		GX_SetTexCopyDst(width, height, GX_TF_RGBA8, GX_FALSE);
+		GX_CopyTex(pixels, GX_FALSE);
+		GX_PixModeSync();
+
+		return pixels;
+	}
+	// Hands a copied frame to the loader thread for PNG encoding and to the callbacks, GX must be done with it. The
+	// pixels are freed before any callback runs and every callback runs even if one fails, the first error is
+	// returned so present can finish the frame before raising it.
+	std::string deliverScreenshot(unsigned char *pixels, unsigned int width, unsigned int height, unsigned int size) {
+		std::vector<std::string> files;
+		std::vector<sol::protected_function> callbacks;
+		std::vector<sol::object> images;
+		std::string error;
+
+		files.swap(screenshotFiles); // Callbacks may request more, those wait for the next frame
+		callbacks.swap(screenshotCallbacks);
+
+		DCInvalidateRange(pixels, size);
+
+		for (const std::string &filename : files) {
+			unsigned char *copy = static_cast<unsigned char *>(std::malloc(size));
+
+			std::memcpy(copy, pixels, size);
+
+			love::loader::saveScreenshot(copy, width, height, filename);
+		}
+
+		try {
+			for (sol::protected_function &callback : callbacks) {
+				sol::object imageData = sol::make_object<ImageData>(callback.lua_state(), width, height, "rgba8");
+
+				std::memcpy(imageData.as<ImageData &>().data, pixels, size);
+
+				images.push_back(imageData);
+			}
+		} catch (const std::exception &exception) { // Callbacks without an image are dropped
+			error = exception.what();
+		}
+
+		std::free(pixels);
+
+		for (unsigned int i = 0; i < images.size(); i++) {
+			sol::protected_function_result result = callbacks[i](images[i]);
+
+			if (!result.valid() && error.empty()) error = result.get<sol::error>().what();
+		}
+
+		return error;
+	}
+
+	// Retraces each frame should take, more than one when the frame limit is below the refresh rate
+	unsigned int getRetracesPerFrame() {
+		if (frameInterval == 0 || retracePeriod == 0) return 1;
+
+		return std::max(1.0, std::round(static_cast<double>(frameInterval) / static_cast<double>(retracePeriod)));
+	}
+
+	// Polyline joins
+	enum class LineJoin {
+		miter,
+		bevel,
+		none
+	};
+	std::map<std::string, LineJoin> lineJoinMap = {
+		{"miter", LineJoin::miter},
+		{"bevel", LineJoin::bevel},
+		{"none", LineJoin::none}
+	};
+	LineJoin lineJoin;
+
+	constexpr float miterLimit = 4.0f; // Miters longer than this (in line widths) fall back to bevels
+	constexpr int luaTypeCData = 10; // LuaJIT's cdata type tag (not exported by lua.h)
+	constexpr double maxLineCoords = 1 << 20; // FFI counts past this are taken for garbage rather than read
+
+	// Scratch buffers are kept around so polylines don't allocate every frame
+	std::vector<float> lineCoords;
+	std::vector<unsigned int> linePoints;
+	std::vector<std::pair<float, float>> lineNormals;
+	std::vector<guVector> lineStrip;
+
+	// Emits a joined polyline (count points, interleaved x/y) as a single primitive
+	void drawPolyline(const float *coords, unsigned int count) {
+		flushBatch();
+
+		unsigned int color = GRRLIB_Settings.color;
+		float halfWidth = static_cast<float>(GRRLIB_Settings.lineWidth) / 12.0f; // GX line widths are in 1/6 pixel units
+
+		std::vector<guVector> &v = lineStrip;
+		std::vector<unsigned int> &points = linePoints;
+		std::vector<std::pair<float, float>> &normals = lineNormals;
+
+		v.clear();
+		points.clear();
+		normals.clear();
+
+		// Segment normals (zero-length segments are skipped)
+		for (unsigned int i = 0; i < count; i++) {
+			if (!points.empty() && coords[points.back() * 2] == coords[i * 2] && coords[points.back() * 2 + 1] == coords[i * 2 + 1])
+				continue;
+
+			points.push_back(i);
+		}
+		if (points.size() < 2) return;
+
+		for (unsigned int i = 0; i + 1 < points.size(); i++) {
+			float dx = coords[points[i + 1] * 2] - coords[points[i] * 2];
+			float dy = coords[points[i + 1] * 2 + 1] - coords[points[i] * 2 + 1];
+			float length = std::sqrt(dx * dx + dy * dy);
+
+			normals.push_back(std::make_pair(-dy / length, dx / length));
+		}
+
+		if (lineJoin == LineJoin::none) { // Unjoined segments, one quad each
+			for (unsigned int i = 0; i < normals.size(); i++) {
+				float x1 = coords[points[i] * 2], y1 = coords[points[i] * 2 + 1];
+				float x2 = coords[points[i + 1] * 2], y2 = coords[points[i + 1] * 2 + 1];
+				float nx = normals[i].first * halfWidth, ny = normals[i].second * halfWidth;
+
+				v.push_back({x1 + nx, y1 + ny, 0.0f});
+				v.push_back({x2 + nx, y2 + ny, 0.0f});
+				v.push_back({x2 - nx, y2 - ny, 0.0f});
+				v.push_back({x1 - nx, y1 - ny, 0.0f});
+			}
+		} else { // Joined triangle strip, two vertices (left, right) per join
+			float x = coords[points[0] * 2], y = coords[points[0] * 2 + 1];
+			float nx = normals[0].first * halfWidth, ny = normals[0].second * halfWidth;
+
+			v.push_back({x + nx, y + ny, 0.0f});
+			v.push_back({x - nx, y - ny, 0.0f});
+
+			for (unsigned int i = 1; i < normals.size(); i++) {
+				float ax = normals[i - 1].first, ay = normals[i - 1].second;
+				float bx = normals[i].first, by = normals[i].second;
+				float mx = ax + bx, my = ay + by;
+				float mLength = std::sqrt(mx * mx + my * my);
+
+				x = coords[points[i] * 2];
+				y = coords[points[i] * 2 + 1];
+
+				if (mLength < 1e-4f) { // Line doubles back on itself, nothing to join
+					v.push_back({x + ax * halfWidth, y + ay * halfWidth, 0.0f});
+					v.push_back({x - ax * halfWidth, y - ay * halfWidth, 0.0f});
+					v.push_back({x + bx * halfWidth, y + by * halfWidth, 0.0f});
+					v.push_back({x - bx * halfWidth, y - by * halfWidth, 0.0f});
+
+					continue;
+				}
+
+				// Miter direction and length
+				mx /= mLength;
+				my /= mLength;
+				float miter = halfWidth / (mx * ax + my * ay);
+
+				if (lineJoin == LineJoin::miter && miter <= miterLimit * halfWidth) {
+					v.push_back({x + mx * miter, y + my * miter, 0.0f});
+					v.push_back({x - mx * miter, y - my * miter, 0.0f});
+				} else if (ax * by - ay * bx > 0.0f) { // Turning towards the left side, bevel on the right
+					v.push_back({x + mx * miter, y + my * miter, 0.0f});
+					v.push_back({x - ax * halfWidth, y - ay * halfWidth, 0.0f});
+					v.push_back({x + mx * miter, y + my * miter, 0.0f});
+					v.push_back({x - bx * halfWidth, y - by * halfWidth, 0.0f});
+				} else { // Turning towards the right side, bevel on the left
+					v.push_back({x + ax * halfWidth, y + ay * halfWidth, 0.0f});
+					v.push_back({x - mx * miter, y - my * miter, 0.0f});
+					v.push_back({x + bx * halfWidth, y + by * halfWidth, 0.0f});
+					v.push_back({x - mx * miter, y - my * miter, 0.0f});
+				}
+			}
+
+			x = coords[points.back() * 2];
+			y = coords[points.back() * 2 + 1];
+			nx = normals.back().first * halfWidth;
+			ny = normals.back().second * halfWidth;
+
+			v.push_back({x + nx, y + ny, 0.0f});
+			v.push_back({x - nx, y - ny, 0.0f});
+		}
+
+		GX_SetTevOp(GX_TEVSTAGE0, GX_PASSCLR);
+		GX_SetVtxDesc(GX_VA_TEX0, GX_NONE);
+
+		// GX_Begin takes a 16-bit vertex count, so very long lines are split (strips overlap by one join)
+		constexpr unsigned int maxVertices = 65532;
+		unsigned int start = 0;
+		while (start < v.size()) {
+			unsigned int size = std::min<unsigned int>(v.size() - start, maxVertices);
+
+			GX_Begin(lineJoin == LineJoin::none ? GX_QUADS : GX_TRIANGLESTRIP, GX_VTXFMT0, size);
+			for (unsigned int i = start; i < start + size; i++) {
+				GX_Position3f32(v[i].x, v[i].y, v[i].z);
+				GX_Color1u32(color);
+			}
+			GX_End();
+
+			stats.drawCalls++;
+
+			if (start + size >= v.size()) break;
+			start += lineJoin == LineJoin::none ? size : size - 2;
+		}
+	}
+}
+
+// Current GRRLIB matrix as a GX matrix
+void getMatrix(Mtx matrix) {
+	static_assert(sizeof(GRRLIB_matrix) == sizeof(Mtx), "GRRLIB_matrix is expected to wrap a GX Mtx");
+
+	GRRLIB_matrix matrixObject = GRRLIB_GetMatrix();
+
+	std::memcpy(matrix, &matrixObject, sizeof(Mtx));
+}
+void setMatrix(const Mtx matrix) {
+	GRRLIB_matrix matrixObject;
+
+	std::memcpy(&matrixObject, matrix, sizeof(Mtx));
+
+	GRRLIB_SetMatrix(&matrixObject);
+}
+
+// Folds a LÖVE-style draw transform into matrix, only the 2D part of the result is written
+void composeDrawTransform(const Mtx matrix, float x, float y, float r, float sx, float sy, float ox, float oy, Mtx result) {
+	float cosR = 1.0f, sinR = 0.0f;
+
+	if (r != 0.0f) {
+		cosR = std::cos(DegToRad(r));
+		sinR = std::sin(DegToRad(r));
+	}
+
+	// translate(x, y) * rotate(r) * scale(sx, sy) * translate(-ox, -oy)
+	float a = cosR * sx, b = -sinR * sy, c = sinR * sx, d = cosR * sy;
+	float tx = x - a * ox - b * oy, ty = y - c * ox - d * oy;
+
+	result[0][0] = matrix[0][0] * a + matrix[0][1] * c;
+	result[0][1] = matrix[0][0] * b + matrix[0][1] * d;
+	result[0][3] = matrix[0][0] * tx + matrix[0][1] * ty + matrix[0][3];
+	result[1][0] = matrix[1][0] * a + matrix[1][1] * c;
+	result[1][1] = matrix[1][0] * b + matrix[1][1] * d;
+	result[1][3] = matrix[1][0] * tx + matrix[1][1] * ty + matrix[1][3];
+}
+
+// Writes the screen-space corners of a rectWidth x rectHeight rectangle drawn LÖVE-style under matrix
+void transformRect(const Mtx matrix, float rectWidth, float rectHeight, float x, float y, float r, float sx, float sy, float ox, float oy, float (&corners)[4][2]) {
+	Mtx draw;
+
+	composeDrawTransform(matrix, x, y, r, sx, sy, ox, oy, draw);
+
+	float m00 = draw[0][0], m01 = draw[0][1], m03 = draw[0][3];
+	float m10 = draw[1][0], m11 = draw[1][1], m13 = draw[1][3];
+
+	corners[0][0] = m03;
+	corners[0][1] = m13;
+	corners[1][0] = m00 * rectWidth + m03;
+	corners[1][1] = m10 * rectWidth + m13;
+	corners[2][0] = m00 * rectWidth + m01 * rectHeight + m03;
+	corners[2][1] = m10 * rectWidth + m11 * rectHeight + m13;
+	corners[3][0] = m01 * rectHeight + m03;
+	corners[3][1] = m11 * rectHeight + m13;
+}
+
+namespace {
+	struct ScreenBox {
+		float minX, minY, maxX, maxY;
+	};
+
+	// Bounding box of a screen-space quad, and the visible area (viewport and scissor)
+	ScreenBox boundCorners(const float (&corners)[4][2]) {
+		ScreenBox box = {corners[0][0], corners[0][1], corners[0][0], corners[0][1]};
+
+		for (int i = 1; i < 4; i++) {
+			box.minX = std::min(box.minX, corners[i][0]);
+			box.maxX = std::max(box.maxX, corners[i][0]);
+			box.minY = std::min(box.minY, corners[i][1]);
+			box.maxY = std::max(box.maxY, corners[i][1]);
+		}
+
+		return box;
+	}
+	ScreenBox getClipBox() {
+		return {static_cast<float>(scissorX), static_cast<float>(scissorY), std::min<float>(scissorX + scissorWidth, width),
+			std::min<float>(scissorY + scissorHeight, height)};
+	}
+
+	// Writes the screen-space corners a rectWidth x rectHeight rectangle, drawn with a LÖVE-style draw transform under
+	// the current matrix, can cover. Rotated rectangles are widened to the circle around the pivot.
+	void transformBounds(float rectWidth, float rectHeight, float x, float y, float r, float sx, float sy, float ox, float oy, float (&corners)[4][2]) {
+		Mtx matrix;
+
+		getMatrix(matrix);
+
+		if (r == 0.0f) {
+			transformRect(matrix, rectWidth, rectHeight, x, y, 0.0f, sx, sy, ox, oy, corners);
+		} else { // Any rotation stays within the circle around the pivot
+			float dx = std::max(std::fabs(ox), std::fabs(rectWidth - ox)) * std::fabs(sx);
+			float dy = std::max(std::fabs(oy), std::fabs(rectHeight - oy)) * std::fabs(sy);
+			float radius = std::sqrt(dx * dx + dy * dy);
+
+			transformRect(matrix, radius * 2.0f, radius * 2.0f, x - radius, y - radius, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, corners);
+		}
+	}
+
+	// Returns whether a screen-space quad lies entirely within the visible area
+	bool isInsideScreen(const float (&corners)[4][2]) {
+		ScreenBox box = boundCorners(corners), clip = getClipBox();
+
+		return box.minX >= clip.minX && box.maxX <= clip.maxX && box.minY >= clip.minY && box.maxY <= clip.maxY;
+	}
+}
+
+// Returns whether a screen-space quad can touch the visible area (viewport and scissor)
+bool isOnScreen(const float (&corners)[4][2]) {
+	ScreenBox box = boundCorners(corners), clip = getClipBox();
+
+	return box.maxX > clip.minX && box.minX < clip.maxX && box.maxY > clip.minY && box.minY < clip.maxY;
+}
+
+// Returns whether a rectWidth x rectHeight rectangle, drawn with a LÖVE-style draw transform under the
+// current matrix, can touch the visible area. Conservative: false means it is certainly invisible.
+bool isVisible(float rectWidth, float rectHeight, float x, float y, float r, float sx, float sy, float ox, float oy) {
+	float corners[4][2];
+
+	transformBounds(rectWidth, rectHeight, x, y, r, sx, sy, ox, oy, corners);
+
+	return isOnScreen(corners);
+}
+
+// Keeps the texture memory statistic up to date, called by textures as they are created and freed
+void trackTextureMemory(int bytes) {
+	textureMemory += bytes;
+}
+
+// Adds a textured screen-space quad to the batch, flushing first if the texture changes
+void batchQuad(const Texture &texture, const float (&corners)[4][2], float u0, float v0, float u1, float v1, unsigned int color) {
+	texture.makeResident();
+
+	if (batchTexture != texture.texture || batch.size() + 4 > maxBatchVertices) {
+		flushBatch();
+
+		batchTexture = texture.texture;
+		batchFormat = texture.format;
+		batchMaxLOD = texture.maxLOD;
+	}
+
+	batch.push_back({corners[0][0], corners[0][1], u0, v0, color});
+	batch.push_back({corners[1][0], corners[1][1], u1, v0, color});
+	batch.push_back({corners[2][0], corners[2][1], u1, v1, color});
+	batch.push_back({corners[3][0], corners[3][1], u0, v1, color});
+}
+
+// Binds a texture to GX_TEXMAP0 with the filtering the current settings ask for
+void loadTexture(const GRRLIB_texture *texture, unsigned char format, unsigned char maxLOD) {
+	GXTexObj texObj;
+
+	GX_InitTexObj(&texObj, texture->data, texture->width, texture->height, format, GX_CLAMP, GX_CLAMP, maxLOD > 0);
+	if (GRRLIB_Settings.antialias == false) {
+		GX_InitTexObjLOD(&texObj, maxLOD > 0 ? GX_NEAR_MIP_NEAR : GX_NEAR, GX_NEAR, 0.0f, maxLOD, 0.0f, GX_FALSE, GX_FALSE, GX_ANISO_1);
+	} else if (maxLOD > 0) {
+		GX_InitTexObjLOD(&texObj, GX_LIN_MIP_LIN, GX_LINEAR, 0.0f, maxLOD, 0.0f, GX_FALSE, GX_FALSE, GX_ANISO_1);
+	}
+	GX_LoadTexObj(&texObj, GX_TEXMAP0);
+}
+
+// Submits all batched quads, must be called before anything else touches GX
+void flushBatch() {
+	if (batch.empty()) return;
+
+	unsigned int count = batch.size();
+	bool compact = vertexFormat == VertexFormat::compact;
+	bool indexed = compact;
+	unsigned int paletteStart = (paletteUsed + 7) & ~7u; // Keep each palette 32-byte aligned
+	unsigned int colors = 0;
+
+	GRRLIB_matrix matrixObject = GRRLIB_GetMatrix();
+	Mtx matrix;
+
+	if (compact) {
+		batchColorIndices.clear();
+
+		for (unsigned int i = 0; i < count; i += 4) {
+			// s16 positions only cover a limited range around the screen
+			for (unsigned int j = i; j < i + 4; j++) {
+				if (std::fabs(batch[j].x) >= positionLimit || std::fabs(batch[j].y) >= positionLimit) compact = false;
+			}
+
+			if (indexed) { // Quads share one color, so one palette lookup each
+				unsigned int color = batch[i].color;
+				unsigned int index = 0;
+
+				while (index < colors && palette[paletteStart + index] != color) index++;
+
+				if (index == colors) {
+					if (colors == 256 || paletteStart + colors >= paletteSize) {
+						indexed = false;
+					} else {
+						palette[paletteStart + colors++] = color;
+					}
+				}
+
+				batchColorIndices.push_back(index);
+			}
+		}
+	}
+
+	// Vertices are already in screen space, so only keep the depth part of the current matrix
+	std::memcpy(matrix, &matrixObject, sizeof(Mtx));
+	for (int row = 0; row < 2; row++) {
+		for (int column = 0; column < 4; column++) matrix[row][column] = row == column ? 1.0f : 0.0f;
+	}
+	setMatrix(matrix);
+
+	loadTexture(batchTexture, batchFormat, batchMaxLOD);
+	GX_SetTevOp(GX_TEVSTAGE0, GX_MODULATE);
+	GX_SetVtxDesc(GX_VA_TEX0, GX_DIRECT);
+
+	if (compact) {
+		if (indexed) {
+			paletteUsed = paletteStart + colors;
+
+			DCFlushRange(&palette[paletteStart], colors * sizeof(unsigned int));
+			GX_InvalidateVtxCache();
+			GX_SetArray(GX_VA_CLR0, &palette[paletteStart], sizeof(unsigned int));
+			GX_SetVtxDesc(GX_VA_CLR0, GX_INDEX8);
+		}
+
+		GX_Begin(GX_QUADS, compactVertexFormat, count);
+		for (unsigned int i = 0; i < count; i++) {
+			const BatchVertex &v = batch[i];
+
+			GX_Position2s16(static_cast<short>(std::lrint(v.x * positionScale)), static_cast<short>(std::lrint(v.y * positionScale)));
+			if (indexed)
+				GX_Color1x8(batchColorIndices[i >> 2]);
+			else
+				GX_Color1u32(v.color);
+			GX_TexCoord2u16(static_cast<unsigned short>(std::clamp(v.u, 0.0f, 1.0f) * texCoordScale), static_cast<unsigned short>(std::clamp(v.v, 0.0f, 1.0f) * texCoordScale));
+		}
+		GX_End();
+
+		GX_SetVtxDesc(GX_VA_CLR0, GX_DIRECT);
+
+		stats.vertexBytes += count * (indexed ? 9 : 12);
+	} else {
+		GX_Begin(GX_QUADS, GX_VTXFMT0, count);
+		for (const BatchVertex &v : batch) {
+			GX_Position3f32(v.x, v.y, 0.0f);
+			GX_Color1u32(v.color);
+			GX_TexCoord2f32(v.u, v.v);
+		}
+		GX_End();
+
+		stats.vertexBytes += count * 24;
+	}
+
+	GX_SetTevOp(GX_TEVSTAGE0, GX_PASSCLR);
+	GX_SetVtxDesc(GX_VA_TEX0, GX_NONE);
+
+	GRRLIB_SetMatrix(&matrixObject);
+
+	stats.drawCalls++;
+
+	batch.clear();
+	batchTexture = nullptr;
+}
+
+// Frees a buffer GX may still read once no queued or drawing frame can use it
+void releaseAfterFrame(void *buffer) {
+	if (buffer != nullptr) retiredBuffers[retiring].push_back(buffer);
+}
+
+// Counts presents, so per-frame work can tell whether a new frame started
+unsigned int getPresentCount() {
+	return presentCount;
+}
+
+// Waits for GX to finish the frame of an asynchronous present, before freeing anything it may read
+void waitForFrame() {
+	waitForFramebuffers(FrameWait::drawn);
+}
+// Waits for the frame of an asynchronous present to reach the display
+void waitForPresent() {
+	waitForFramebuffers(FrameWait::shown);
 }
 
 void init() {
@@ -66,11 +813,83 @@ void init() {
 	widescreen = CONF_GetAspectRatio() == CONF_ASPECT_16_9;
 #endif // !HW_DOL
 
+	// Compact vertex format for batches
+	GX_SetVtxAttrFmt(compactVertexFormat, GX_VA_POS, GX_POS_XY, GX_S16, positionFraction);
+	GX_SetVtxAttrFmt(compactVertexFormat, GX_VA_CLR0, GX_CLR_RGBA, GX_RGBA8, 0);
+	GX_SetVtxAttrFmt(compactVertexFormat, GX_VA_TEX0, GX_TEX_ST, GX_U16, texCoordFraction);
+
+	// Tile map vertex format, only used through indices
+	GX_SetVtxAttrFmt(tileVertexFormat, GX_VA_POS, GX_POS_XY, GX_S16, 0);
+	GX_SetVtxAttrFmt(tileVertexFormat, GX_VA_CLR0, GX_CLR_RGBA, GX_RGBA8, 0);
+	GX_SetVtxAttrFmt(tileVertexFormat, GX_VA_TEX0, GX_TEX_ST, GX_F32, 0);
+
+	// Asynchronous presents
+	LWP_InitQueue(&presentQueue);
+	GX_SetDrawSyncCallback(presentDrawn);
+	nextRetraceCallback = VIDEO_SetPostRetraceCallback(presentRetrace);
+	presentRetraceCount = VIDEO_GetRetraceCount();
+
+	batch.reserve(maxBatchVertices);
+
 	curFont = new Font();
 
 	module::reset(); // Set defaults
 }
 
+namespace {
+	// Text of a print call, colors holds one color per character for colored text or is nullptr
+	void printText(const std::wstring &text, const uint32_t *colors, float x, float y, float r, float sx, float sy, float ox, float oy) {
+		FreeTypeGX *fontSystem = curFont->fontSystem;
+
+		if (fontSystem == nullptr) { // Image font, glyphs go through the sprite batch
+			Mtx matrix, draw;
+
+			getMatrix(matrix);
+			composeDrawTransform(matrix, x, y, r, sx, sy, ox, oy, draw);
+
+			if (curFont->printImage(text, draw, GRRLIB_Settings.color, colors) == 0) stats.culledDraws++;
+
+			return;
+		}
+
+		// Glyphs hang around the baseline and rotate individually, so the text box is padded by its height
+		auto textCorners = [&](float textWidth, float textHeight, float (&corners)[4][2]) {
+			transformBounds(textWidth + textHeight * 2.0f, textHeight * 3.0f, x, y, r, sx, sy, ox + textHeight, oy + textHeight * 2.0f, corners);
+		};
+
+		// Cull against a bound from the character and line counts first. The widest advance is well above the average
+		// one, so the bound holds the measured box, which is only needed when the bound straddles an edge.
+		size_t lines = 1, columns = 0, longest = 0;
+		float corners[4][2];
+
+		for (wchar_t character : text) {
+			if (character == L'\n') {
+				lines++;
+				columns = 0;
+			} else {
+				columns += character == L'\t' ? 4 : 1;
+				longest = std::max(longest, columns);
+			}
+		}
+
+		textCorners(longest * fontSystem->getMaxAdvance(), (lines + 2) * fontSystem->getLineHeight(), corners);
+
+		if (isOnScreen(corners) && !isInsideScreen(corners)) {
+			textCorners(fontSystem->getWidth(text.c_str()), fontSystem->getHeight(text.c_str()), corners);
+		}
+		if (!isOnScreen(corners)) {
+			stats.culledDraws++;
+
+			return;
+		}
+
+		flushBatch();
+
+		fontSystem->drawText(x, y, text, sx, sy, ox, oy, r, FTGX_NULL, colors);
+		stats.drawCalls++;
+	}
+}
+
 namespace module {
 
 // Misc. querying functions
@@ -87,15 +906,27 @@ bool isWidescreen() { return widescreen; }
 void origin() {
 	GRRLIB_Origin();
 }
-void pop() {
-	if (transforms.empty()) { throw std::runtime_error("Stack is empty"); }
+void applyTransform(const love::math::Transform &transform) {
+	Mtx matrix;
 
-	GRRLIB_SetMatrix(&transforms.back()); // Use previously stored transform before removing it
+	getMatrix(matrix);
+	guMtxConcat(matrix, transform.matrix, matrix);
+	setMatrix(matrix);
+}
+void pop() {
+	if (stackDepth == 0) { throw std::runtime_error("Stack is empty"); }
 
-	transforms.pop_back();
+	GRRLIB_SetMatrix(&transforms[--stackDepth]); // Use previously stored transform before removing it
 }
 void push() {
-	transforms.push_back(GRRLIB_GetMatrix()); // Store the current transform for later
+	if (stackDepth == maxStackDepth) { throw std::runtime_error("Stack overflow (too many pushes without pops)"); }
+
+	transforms[stackDepth++] = GRRLIB_GetMatrix(); // Store the current transform for later
+}
+void replaceTransform(const love::math::Transform &transform) {
+	GRRLIB_Origin(); // Keep GRRLIB's base view transform underneath
+
+	applyTransform(transform);
 }
 void rotate(float angle) {
 	GRRLIB_Rotate(angle);
@@ -109,6 +940,8 @@ void translate(float dx, float dy) {
 
 // Set and get drawing colors
 void clear(unsigned char r, unsigned char g, unsigned char b, unsigned char a) {
+	flushBatch();
+
 	GRRLIB_FillScreen(GRRLIB_RGBA(r, g, b, a));
 }
 std::tuple<unsigned char, unsigned char, unsigned char, unsigned char> getBackgroundColor() {
@@ -130,15 +963,67 @@ void setColor(unsigned char r, unsigned char g, unsigned char b, unsigned char a
 
 // Basic drawing functions
 void ellipse(bool fill, float x, float y, float radiusX, float radiusY) {
+	flushBatch();
+
 	GRRLIB_Ellipse(x, y, radiusX, radiusY, fill);
+	stats.drawCalls++;
 }
-void line(float x1, float y1, float x2, float y2) {
+void line(float x1, float y1, float x2, float y2) { // Single segments stay on GRRLIB's line path
+	flushBatch();
+
 	GRRLIB_Line(x1, y1, x2, y2);
+	stats.drawCalls++;
+}
+void line1(sol::table vertices) {
+	unsigned int size = vertices.size();
+
+	if (size % 2 != 0) { throw std::runtime_error("Coordinate count must be even"); }
+
+	lineCoords.clear();
+	lineCoords.reserve(size);
+
+	for (unsigned int i = 1; i <= size; i++) {
+		lineCoords.push_back(vertices.raw_get<float>(i));
+	}
+
+	drawPolyline(lineCoords.data(), size / 2);
+}
+void line2(sol::variadic_args vertices, sol::this_state s) {
+	// FFI arrays: line(float[?] array, count), count coordinates like the table form. A cdata's length can't be
+	// read from C, so the caller guarantees the array holds count floats; only the count itself is checked.
+	if (vertices.size() == 2 && lua_type(s, vertices.stack_index()) == luaTypeCData) {
+		double count = vertices.get<double>(1);
+
+		if (count < 0.0 || count > maxLineCoords || count != std::floor(count)) { throw std::runtime_error("Invalid coordinate count"); }
+		if (static_cast<unsigned int>(count) % 2 != 0) { throw std::runtime_error("Coordinate count must be even"); }
+
+		drawPolyline(static_cast<const float *>(lua_topointer(s, vertices.stack_index())), static_cast<unsigned int>(count) / 2);
+
+		return;
+	}
+
+	unsigned int size = vertices.size();
+
+	if (size % 2 != 0) { throw std::runtime_error("Coordinate count must be even"); }
+
+	lineCoords.clear();
+	lineCoords.reserve(size);
+
+	for (unsigned int i = 0; i < size; i++) {
+		lineCoords.push_back(vertices.get<float>(i));
+	}
+
+	drawPolyline(lineCoords.data(), size / 2);
 }
 void points(float x, float y) { // Tiny optimzation so we don't have to do so much for two coordinates :P
+	flushBatch();
+
 	GRRLIB_Point(x, y);
+	stats.drawCalls++;
 }
 void points1(sol::table vertexTable) {
+	flushBatch();
+
 	if (vertexTable[1].is<sol::table>() == true) {
 		std::pair<std::vector<guVector>, std::vector<unsigned int>> v;
 		unsigned int size = vertexTable.size();
@@ -161,6 +1046,7 @@ void points1(sol::table vertexTable) {
 		}
 
 		GRRLIB_Points(v.first.data(), v.second.data(), size);
+		stats.drawCalls++;
 	} else {
 		std::vector<guVector> v;
 		unsigned int size = vertexTable.size();
@@ -172,9 +1058,12 @@ void points1(sol::table vertexTable) {
 		}
 
 		GRRLIB_Points(v.data(), nullptr, size / 2);
+		stats.drawCalls++;
 	}
 }
 void points2(sol::variadic_args vertices) {
+	flushBatch();
+
 	std::vector<guVector> v;
 	unsigned int size = vertices.size();
 
@@ -185,8 +1074,11 @@ void points2(sol::variadic_args vertices) {
 	}
 
 	GRRLIB_Points(v.data(), nullptr, size / 2);
+	stats.drawCalls++;
 }
 void polygon(bool fill, sol::table vertices) {
+	flushBatch();
+
 	std::vector<guVector> v;
 	unsigned int size = vertices.size();
 
@@ -197,8 +1089,11 @@ void polygon(bool fill, sol::table vertices) {
 	}
 
 	GRRLIB_Polygon(v.data(), size / 2, fill);
+	stats.drawCalls++;
 }
 void polygon1(bool fill, sol::variadic_args vertices) {
+	flushBatch();
+
 	std::vector<guVector> v;
 	unsigned int size = vertices.size();
 
@@ -209,24 +1104,260 @@ void polygon1(bool fill, sol::variadic_args vertices) {
 	}
 
 	GRRLIB_Polygon(v.data(), size / 2, fill);
+	stats.drawCalls++;
 }
 void rectangle(bool fill, float x, float y, float width, float height) {
+	flushBatch();
+
 	GRRLIB_Rectangle(x, y, width, height, fill);
+	stats.drawCalls++;
 }
 
 // Font functions
 Font *getFont() { return curFont; }
 void print(const std::wstring &text, float x, float y, float r, float sx, float sy, float ox, float oy) {
-	curFont->fontSystem->drawText(x, y, text, sx, sy, ox, oy, r);
+	printText(text, nullptr, x, y, r, sx, sy, ox, oy);
+}
+void print1(sol::table coloredText, float x, float y, float r, float sx, float sy, float ox, float oy) {
+	unsigned int current = GRRLIB_Settings.color, color = current;
+	std::wstring text;
+	std::vector<uint32_t> colors;
+
+	// Runs are laid out as one string, each character keeping the color of its run
+	for (unsigned int i = 1; i <= coloredText.size(); i++) {
+		sol::object entry = coloredText[i];
+
+		if (entry.is<sol::table>()) {
+			sol::table run = entry.as<sol::table>();
+			unsigned int channels[4] = {run.get_or(1, 255u), run.get_or(2, 255u), run.get_or(3, 255u), run.get_or(4, 255u)};
+
+			// Tinted by the current color, like every other draw
+			color = GRRLIB_RGBA(channels[0] * GRRLIB_R(current) / 255, channels[1] * GRRLIB_G(current) / 255, channels[2] * GRRLIB_B(current) / 255, channels[3] * GRRLIB_A(current) / 255);
+		} else if (entry.is<std::wstring>()) {
+			std::wstring run = entry.as<std::wstring>();
+
+			text += run;
+			colors.insert(colors.end(), run.size(), color);
+		} else {
+			throw std::runtime_error("Colored text expects colors and strings");
+		}
+	}
+
+	printText(text, colors.data(), x, y, r, sx, sy, ox, oy);
 }
 void setFont(Font *font) { curFont = font; }
 
+std::tuple<sol::table, sol::table> newAtlas(sol::table paths, unsigned int maxSize, sol::this_state s) {
+	struct Entry {
+		std::string path;
+		GRRLIB_texture *image;
+		unsigned int page, x, y;
+	};
+
+	constexpr unsigned int padding = 1; // Edge pixels are extruded into the padding so filtering doesn't bleed
+
+	sol::state_view lua(s);
+	sol::table textures = lua.create_table();
+	sol::table quads = lua.create_table();
+	std::vector<Entry> entries;
+	std::vector<Entry *> order;
+	std::vector<std::pair<unsigned int, unsigned int>> pageSizes;
+	std::vector<Texture> pages;
+
+	auto freeImages = [&entries]() {
+		for (Entry &entry : entries) GRRLIB_FreeTexture(entry.image);
+	};
+
+	for (std::size_t i = 1; i <= paths.size(); i++) {
+		std::string path = paths.get<std::string>(i);
+		GRRLIB_texture *image = GRRLIB_LoadTextureFromFile(love::filesystem::getFilePath(path).c_str());
+
+		if (image == nullptr) {
+			freeImages();
+
+			throw std::runtime_error("Could not load image: " + path);
+		}
+
+		entries.push_back({path, image, 0, 0, 0});
+
+		if (image->width + padding * 2 > maxSize || image->height + padding * 2 > maxSize) {
+			freeImages();
+
+			throw std::runtime_error("Image too large for atlas: " + path);
+		}
+	}
+
+	// Shelf packing, tallest images first
+	for (Entry &entry : entries) order.push_back(&entry);
+	std::stable_sort(order.begin(), order.end(), [](const Entry *a, const Entry *b) {
+		return a->image->height > b->image->height;
+	});
+
+	unsigned int shelfX = 0, shelfY = 0, shelfHeight = 0;
+
+	for (Entry *entry : order) {
+		unsigned int entryWidth = entry->image->width + padding * 2;
+		unsigned int entryHeight = entry->image->height + padding * 2;
+
+		if (shelfX + entryWidth > maxSize) { // Next shelf
+			shelfX = 0;
+			shelfY += shelfHeight;
+			shelfHeight = 0;
+		}
+		if (pageSizes.empty() || shelfY + entryHeight > maxSize) { // Next page
+			pageSizes.emplace_back(0, 0);
+
+			shelfX = 0;
+			shelfY = 0;
+			shelfHeight = 0;
+		}
+
+		entry->page = pageSizes.size() - 1;
+		entry->x = shelfX + padding;
+		entry->y = shelfY + padding;
+
+		shelfX += entryWidth;
+		shelfHeight = std::max(shelfHeight, entryHeight);
+
+		pageSizes.back().first = std::max(pageSizes.back().first, shelfX);
+		pageSizes.back().second = std::max(pageSizes.back().second, shelfY + entryHeight);
+	}
+
+	// Pages are trimmed to what they use, rounded up to GX's 4x4 tiles
+	pages.reserve(pageSizes.size());
+	for (const std::pair<unsigned int, unsigned int> &size : pageSizes) {
+		GRRLIB_texture *page = GRRLIB_CreateEmptyTexture((size.first + 3) & ~3u, (size.second + 3) & ~3u);
+
+		if (page == nullptr) { throw std::runtime_error("Could not create atlas page"); }
+
+		pages.emplace_back(page);
+	}
+
+	for (Entry &entry : entries) {
+		GRRLIB_texture *page = pages[entry.page].texture;
+		int imageWidth = entry.image->width, imageHeight = entry.image->height;
+
+		for (int y = -static_cast<int>(padding); y < imageHeight + static_cast<int>(padding); y++) {
+			for (int x = -static_cast<int>(padding); x < imageWidth + static_cast<int>(padding); x++) {
+				unsigned int color = GRRLIB_GetPixelFromtexImg(std::clamp(x, 0, imageWidth - 1), std::clamp(y, 0, imageHeight - 1), entry.image);
+
+				GRRLIB_SetPixelTotexImg(entry.x + x, entry.y + y, page, color);
+			}
+		}
+
+		textures[entry.path] = pages[entry.page];
+		quads[entry.path] = sol::make_object<Quad>(s, entry.x, entry.y, imageWidth, imageHeight, page->width, page->height);
+	}
+
+	freeImages();
+
+	for (Texture &page : pages) GRRLIB_FlushTex(page.texture);
+
+	return std::make_tuple(textures, quads);
+}
+
 // Texture functions
 void draw(const Texture &texture, float x, float y, float r, float sx, float sy, float ox, float oy) {
-	GRRLIB_DrawTexturePart(x, y, texture.texture, &texture.texture->part, r, sx, sy, ox, oy);
+	drawQuad1(texture, texture.texture->part, x, y, r, sx, sy, ox, oy);
 }
 void drawQuad(const Texture &texture, const Quad &textureQuad, float x, float y, float r, float sx, float sy, float ox, float oy) {
-	GRRLIB_DrawTexturePart(x, y, texture.texture, textureQuad.texturePart, r, sx, sy, ox, oy);
+	drawQuad1(texture, *textureQuad.texturePart, x, y, r, sx, sy, ox, oy);
+}
+void drawParticles(const ParticleSystem &particleSystem, float x, float y, float r, float sx, float sy, float ox, float oy) {
+	Mtx matrix, draw;
+
+	getMatrix(matrix);
+	composeDrawTransform(matrix, x, y, r, sx, sy, ox, oy, draw);
+
+	particleSystem.render(draw, GRRLIB_Settings.color);
+}
+void drawTileMap(TileMap &tileMap, float x, float y, float r, float sx, float sy, float ox, float oy) {
+	GRRLIB_matrix matrixObject = GRRLIB_GetMatrix();
+	Mtx current, matrix;
+
+	flushBatch();
+
+	// Map the visible area back into map space to find the chunks that can touch it
+	std::memcpy(current, &matrixObject, sizeof(Mtx));
+	std::memcpy(matrix, current, sizeof(Mtx)); // Keep the depth row
+	composeDrawTransform(current, x, y, r, sx, sy, ox, oy, matrix);
+
+	float determinant = matrix[0][0] * matrix[1][1] - matrix[0][1] * matrix[1][0];
+
+	if (determinant == 0.0f) return;
+
+	float clip[4][2] = {
+		{static_cast<float>(scissorX), static_cast<float>(scissorY)},
+		{std::min<float>(scissorX + scissorWidth, width), static_cast<float>(scissorY)},
+		{std::min<float>(scissorX + scissorWidth, width), std::min<float>(scissorY + scissorHeight, height)},
+		{static_cast<float>(scissorX), std::min<float>(scissorY + scissorHeight, height)}
+	};
+	float left = INFINITY, top = INFINITY, right = -INFINITY, bottom = -INFINITY;
+
+	for (int i = 0; i < 4; i++) {
+		float dx = clip[i][0] - matrix[0][3], dy = clip[i][1] - matrix[1][3];
+		float mapX = (matrix[1][1] * dx - matrix[0][1] * dy) / determinant;
+		float mapY = (matrix[0][0] * dy - matrix[1][0] * dx) / determinant;
+
+		left = std::min(left, mapX);
+		right = std::max(right, mapX);
+		top = std::min(top, mapY);
+		bottom = std::max(bottom, mapY);
+	}
+
+	// The draw color goes through the palette arena so it lives until the frame is drawn
+	unsigned int paletteStart = (paletteUsed + 7) & ~7u;
+
+	if (paletteStart >= paletteSize) { // Full, wait for the GPU to be done with it
+		GX_DrawDone();
+
+		paletteStart = 0;
+	}
+
+	palette[paletteStart] = GRRLIB_Settings.color;
+	paletteUsed = paletteStart + 1;
+
+	DCFlushRange(&palette[paletteStart], sizeof(unsigned int));
+	GX_InvalidateVtxCache();
+
+	tileMap.texture.makeResident();
+	loadTexture(tileMap.texture.texture, tileMap.texture.format, tileMap.texture.maxLOD);
+	GX_SetTevOp(GX_TEVSTAGE0, GX_MODULATE);
+
+	GX_SetArray(GX_VA_CLR0, &palette[paletteStart], sizeof(unsigned int));
+	GX_SetVtxDesc(GX_VA_POS, GX_INDEX16);
+	GX_SetVtxDesc(GX_VA_CLR0, GX_INDEX8);
+	GX_SetVtxDesc(GX_VA_TEX0, GX_INDEX16);
+
+	unsigned int chunks = tileMap.render(matrix, left, top, right, bottom, stats.vertexBytes);
+
+	GX_SetVtxDesc(GX_VA_POS, GX_DIRECT);
+	GX_SetVtxDesc(GX_VA_CLR0, GX_DIRECT);
+	GX_SetVtxDesc(GX_VA_TEX0, GX_NONE);
+	GX_SetTevOp(GX_TEVSTAGE0, GX_PASSCLR);
+
+	GRRLIB_SetMatrix(&matrixObject);
+
+	stats.drawCalls += chunks;
+	if (chunks == 0) stats.culledDraws++;
+}
+void drawVideo(Video &video, float x, float y, float r, float sx, float sy, float ox, float oy) {
+	draw(video.getFrame(), x, y, r, sx, sy, ox, oy);
+}
+void drawQuad1(const Texture &texture, const GRRLIB_texturePart &part, float x, float y, float r, float sx, float sy, float ox, float oy) {
+	float corners[4][2];
+	Mtx matrix;
+
+	getMatrix(matrix);
+	transformRect(matrix, part.width, part.height, x, y, r, sx, sy, ox, oy, corners);
+
+	if (!isOnScreen(corners)) {
+		stats.culledDraws++;
+
+		return;
+	}
+
+	batchQuad(texture, corners, part.x / part.textureWidth, part.y / part.textureHeight, (part.x + part.width) / part.textureWidth, (part.y + part.height) / part.textureHeight, GRRLIB_Settings.color);
 }
 
 // Graphics state functions
@@ -236,6 +1367,13 @@ bool getAntiAliasing() {
 unsigned char getDeflicker() {
 	return GRRLIB_Settings.deflicker;
 }
+std::string getLineJoin() {
+	for (const std::pair<const std::string, LineJoin> &join : lineJoinMap) {
+		if (join.second == lineJoin) return join.first;
+	}
+
+	return "miter";
+}
 unsigned char getLineWidth() {
 	return GRRLIB_Settings.lineWidth;
 }
@@ -243,11 +1381,43 @@ unsigned char getPointSize() {
 	return GRRLIB_Settings.pointSize;
 }
 std::tuple<unsigned int, unsigned int, unsigned int, unsigned int> getScissor() {
-	unsigned int x, y, width, height;
+	return std::make_tuple(scissorX, scissorY, scissorWidth, scissorHeight);
+}
+sol::table getStats(sol::this_state s) {
+	sol::state_view lua(s);
 
-	GRRLIB_GetScissor(&x, &y, &width, &height);
+	return lua.create_table_with(
+		"drawcalls", stats.drawCalls,
+		"culleddraws", stats.culledDraws,
+		"vertexbytes", stats.vertexBytes,
+		"texturememory", textureMemory,
+		"texturecachememory", love::graphics::getTextureCacheMemory(),
+		"textureevictions", love::graphics::getTextureEvictions(),
+		"lazytexturememory", love::graphics::getLazyTextureMemory(),
+		"compressedtexturememory", love::graphics::getCompressedTextureMemory(),
+		"texturedecodes", love::graphics::getTextureDecodes(),
+		"textureunloads", love::graphics::getTextureUnloads(),
+		"framelatency", static_cast<double>(frameLatency),
+		"framesdrawn", static_cast<unsigned int>(framesDrawn),
+		"presentwait", presentWait,
+		"missedvblanks", missedVBlanks
+	);
+}
+unsigned int getTextureCacheBudget() { return love::graphics::getTextureCacheBudget(); }
+std::pair<double, unsigned int> getTextureResidency() { return love::graphics::getTextureResidency(); }
+double getFrameLimit() { return frameLimit; }
+std::string getPresentMode() {
+	return presentMode == PresentMode::sync ? "sync" : "async";
+}
+std::string getVSync() {
+	for (const std::pair<const std::string, VSync> &mode : vsyncMap) {
+		if (mode.second == vsync) return mode.first;
+	}
 
-	return std::make_tuple(x, y, width, height);
+	return "on";
+}
+std::string getVertexFormat() {
+	return vertexFormat == VertexFormat::compact ? "compact" : "float";
 }
 void reset() {
 	GRRLIB_Settings.color = 0xFFFFFFFF;
@@ -259,15 +1429,23 @@ void reset() {
 	GRRLIB_SetDeflicker(true);
 	GRRLIB_SetPointSize(6);
 	GRRLIB_SetLineWidth(6);
+	lineJoin = LineJoin::miter;
 
-	GRRLIB_ResetScissor();
+	setScissor1();
 }
 void setAntiAliasing(bool enable) {
+	flushBatch();
+
 	GRRLIB_Settings.antialias = enable;
 }
 void setDeflicker(bool enable) {
 	GRRLIB_SetDeflicker(enable);
 }
+void setLineJoin(const std::string &join) {
+	if (lineJoinMap.count(join) == 0) { throw std::runtime_error("Invalid line join: " + join); }
+
+	lineJoin = lineJoinMap[join];
+}
 void setLineWidth(unsigned char width) {
 	GRRLIB_SetLineWidth(width);
 }
@@ -275,15 +1453,123 @@ void setPointSize(unsigned char size) {
 	GRRLIB_SetPointSize(size);
 }
 void setScissor(unsigned int x, unsigned int y, unsigned int width, unsigned int height) {
+	flushBatch();
+
 	GRRLIB_SetScissor(x, y, width, height);
+
+	GRRLIB_GetScissor(&scissorX, &scissorY, &scissorWidth, &scissorHeight); // Keep GRRLIB's clamped values
 }
 void setScissor1() {
+	flushBatch();
+
 	GRRLIB_ResetScissor();
+
+	GRRLIB_GetScissor(&scissorX, &scissorY, &scissorWidth, &scissorHeight);
+}
+void setPresentMode(const std::string &mode) {
+	if (presentModeMap.count(mode) == 0) { throw std::runtime_error("Invalid present mode: " + mode); }
+
+	if (presentModeMap[mode] == presentMode) return;
+
+	waitForPresent();
+
+	if (presentModeMap[mode] == PresentMode::async) allocateFramebuffers();
+
+	presentMode = presentModeMap[mode];
+}
+void setFrameLimit(double fps) {
+	if (fps < 0.0) { throw std::runtime_error("Invalid frame limit"); }
+
+	frameLimit = fps;
+	frameInterval = fps == 0.0 ? 0 : static_cast<unsigned long long>(TB_TIMER_CLOCK * 1000.0 / fps);
+	nextFrameTime = gettime() + frameInterval;
+}
+void setVSync(const std::string &mode) {
+	if (vsyncMap.count(mode) == 0) { throw std::runtime_error("Invalid vsync mode: " + mode); }
+
+	if (vsyncMap[mode] == vsync) return;
+
+	waitForPresent();
+
+	if (vsyncMap[mode] != VSync::on) allocateFramebuffers(); // GRRLIB_Render always waits for the retrace
+
+	vsync = vsyncMap[mode];
+}
+void setTextureCacheBudget(unsigned int bytes) { love::graphics::setTextureCacheBudget(bytes); }
+void setTextureResidency(double idleTime, unsigned int budget) { love::graphics::setTextureResidency(idleTime, budget); }
+void setVertexFormat(const std::string &format) {
+	if (vertexFormatMap.count(format) == 0) { throw std::runtime_error("Invalid vertex format: " + format); }
+
+	flushBatch();
+
+	vertexFormat = vertexFormatMap[format];
 }
 
 // Rendering functions
+void captureScreenshot(const std::string &filename) { // Saved to save/ in the background, see love.screenshot
+	screenshotFiles.push_back(filename);
+}
+void captureScreenshot1(sol::function callback) { // Called with an ImageData during the next present
+	screenshotCallbacks.push_back(callback);
+}
 void present() {
-	GRRLIB_Render();
+	flushBatch();
+
+	limitFrameRate();
+
+	unsigned char *screenshot = nullptr;
+	unsigned int screenshotWidth, screenshotHeight, screenshotSize;
+	std::string screenshotError;
+
+	if (!screenshotFiles.empty() || !screenshotCallbacks.empty()) screenshot = copyScreenshot(screenshotWidth, screenshotHeight, screenshotSize);
+
+	unsigned int retracesPerFrame = getRetracesPerFrame();
+	bool late = VIDEO_GetRetraceCount() - presentRetraceCount >= retracesPerFrame; // Its retrace has passed already
+	bool waitForRetrace = vsync == VSync::on || (vsync == VSync::adaptive && !late);
+	unsigned long long waitStart = gettime();
+
+	if (presentMode == PresentMode::sync && vsync == VSync::on) {
+		GRRLIB_Render();
+
+		framesDrawn = framesDrawn + 1;
+	} else if (presentMode == PresentMode::sync) {
+		submitFrame(waitForRetrace);
+		waitForFramebuffers(waitForRetrace ? FrameWait::shown : FrameWait::drawn);
+	} else {
+		waitForFramebuffers(FrameWait::room); // Up to two frames ahead of the display, one queued and one drawing
+		submitFrame(waitForRetrace);
+	}
+
+	presentWait = static_cast<double>(gettime() - waitStart) / static_cast<double>(TB_TIMER_CLOCK);
+
+	if (screenshot != nullptr) {
+		waitForFrame(); // Only async presents return before GX is done
+
+		screenshotError = deliverScreenshot(screenshot, screenshotWidth, screenshotHeight, screenshotSize);
+	}
+
+	// Count the retraces this frame took beyond its share
+	unsigned int retraces = VIDEO_GetRetraceCount() - presentRetraceCount;
+
+	if (retraces > retracesPerFrame) missedVBlanks += retraces - retracesPerFrame;
+	presentRetraceCount += retraces;
+
+	love::graphics::updateTextureResidency();
+
+	palette = palettes[palette == palettes[0] ? 1 : 0];
+	paletteUsed = 0;
+
+	retiring ^= 1;
+	for (void *buffer : retiredBuffers[retiring]) std::free(buffer);
+	retiredBuffers[retiring].clear();
+
+	presentCount++;
+
+	stats.drawCalls = 0;
+	stats.culledDraws = 0;
+	stats.vertexBytes = 0;
+
+	if (!screenshotError.empty()) { throw std::runtime_error(screenshotError); }
 }
 
 } // module
@@ -22,17 +22,45 @@
 #pragma once
 
 // Libraries
+#include <grrlib-mod.h>
+#include <ogc/gu.h>
 #include <tuple>
 #include <string>
 
 // Classes
 #include "../classes/graphics/font.hpp"
+#include "../classes/graphics/particlesystem.hpp"
+#include "../classes/graphics/quad.hpp"
+#include "../classes/graphics/texture.hpp"
+#include "../classes/graphics/tilemap.hpp"
+#include "../classes/graphics/video.hpp"
+#include "../classes/math/transform.hpp"
 
 namespace love {
 namespace graphics {
 
+constexpr unsigned char tileVertexFormat = GX_VTXFMT2; // Indexed s16 positions and f32 texture coordinates, for tile map display lists
+
 void init();
 
+void waitForFrame();
+void waitForPresent();
+void releaseAfterFrame(void *buffer);
+unsigned int getPresentCount();
+
+void getMatrix(Mtx matrix);
+void setMatrix(const Mtx matrix);
+void composeDrawTransform(const Mtx matrix, float x, float y, float r, float sx, float sy, float ox, float oy, Mtx result);
+void transformRect(const Mtx matrix, float rectWidth, float rectHeight, float x, float y, float r, float sx, float sy, float ox, float oy, float (&corners)[4][2]);
+bool isOnScreen(const float (&corners)[4][2]);
+bool isVisible(float rectWidth, float rectHeight, float x, float y, float r, float sx, float sy, float ox, float oy);
+
+void trackTextureMemory(int bytes);
+
+void loadTexture(const GRRLIB_texture *texture, unsigned char format, unsigned char maxLOD);
+void batchQuad(const Texture &texture, const float (&corners)[4][2], float u0, float v0, float u1, float v1, unsigned int color);
+void flushBatch();
+
 namespace module {
 
 std::pair<int, int> getDimensions();
@@ -49,15 +77,19 @@ void setBackgroundColor(unsigned char r, unsigned char g, unsigned char b, unsig
 void setColor(unsigned char r, unsigned char g, unsigned char b, unsigned char a);
 void setColor1(unsigned char r, unsigned char g, unsigned char b);
 
+void applyTransform(const love::math::Transform &transform);
 void origin();
 void pop();
 void push();
+void replaceTransform(const love::math::Transform &transform);
 void scale(float x, float y);
 void rotate(float angle);
 void translate(float dx, float dy);
 
 void ellipse(bool fill, float x, float y, float radiusX, float radiusY);
 void line(float x1, float y1, float x2, float y2);
+void line1(sol::table vertices);
+void line2(sol::variadic_args vertices, sol::this_state s);
 void points(float x, float y);
 void points1(sol::table vertexTable);
 void points2(sol::variadic_args vertices);
@@ -67,24 +99,48 @@ void rectangle(bool fill, float x, float y, float width, float height);
 
 Font *getFont();
 void print(const std::wstring &text, float x, float y, float r, float sx, float sy, float ox, float oy);
+void print1(sol::table coloredText, float x, float y, float r, float sx, float sy, float ox, float oy);
 void setFont(Font *font);
 
+std::tuple<sol::table, sol::table> newAtlas(sol::table paths, unsigned int maxSize, sol::this_state s);
+
 void draw(const Texture &texture, float x, float y, float r, float sx, float sy, float ox, float oy);
 void drawQuad(const Texture &texture, const Quad &textureQuad, float x, float y, float r, float sx, float sy, float ox, float oy);
+void drawParticles(const ParticleSystem &particleSystem, float x, float y, float r, float sx, float sy, float ox, float oy);
+void drawTileMap(TileMap &tileMap, float x, float y, float r, float sx, float sy, float ox, float oy);
+void drawVideo(Video &video, float x, float y, float r, float sx, float sy, float ox, float oy);
+void drawQuad1(const Texture &texture, const GRRLIB_texturePart &part, float x, float y, float r, float sx, float sy, float ox, float oy);
 
 bool getAntiAliasing();
 unsigned char getDeflicker();
+double getFrameLimit();
+std::string getLineJoin();
 unsigned char getLineWidth();
 unsigned char getPointSize();
+std::string getPresentMode();
 std::tuple<unsigned int, unsigned int, unsigned int, unsigned int> getScissor();
+sol::table getStats(sol::this_state s);
+unsigned int getTextureCacheBudget();
+std::pair<double, unsigned int> getTextureResidency();
+std::string getVertexFormat();
+std::string getVSync();
 void reset();
 void setAntiAliasing(bool enable);
 void setDeflicker(bool enable);
+void setFrameLimit(double fps);
+void setLineJoin(const std::string &join);
 void setLineWidth(unsigned char width);
 void setPointSize(unsigned char size);
+void setPresentMode(const std::string &mode);
 void setScissor(unsigned int x, unsigned int y, unsigned int width, unsigned int height);
 void setScissor1();
+void setTextureCacheBudget(unsigned int bytes);
+void setTextureResidency(double idleTime, unsigned int budget);
+void setVertexFormat(const std::string &format);
+void setVSync(const std::string &mode);
 
+void captureScreenshot(const std::string &filename);
+void captureScreenshot1(sol::function callback);
 void present();
 
 } // module
@@ -0,0 +1,320 @@
+/* WiiLÖVE loader module
+ *
+ * This file is part of WiiLÖVE.
+ *
+ * Copyright (C) 2022  HTV04
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+
+// Libraries
+#include <sol/sol.hpp>
+#if defined(GEKKO)
+#include <gccore.h>
+#else
+#include <pthread.h>
+#endif // GEKKO
+#include <cstdlib>
+#include <deque>
+#include <vector>
+#include <string>
+#include <exception>
+
+// Classes
+#include "../classes/graphics/font.hpp"
+#include "../classes/graphics/imagedata.hpp"
+#include "../classes/graphics/texture.hpp"
+
+// Modules
+#include "event.hpp"
+#include "filesystem.hpp"
+
+// Header
+#include "loader.hpp"
+
+namespace love {
+namespace loader {
+
+// Local variables
+namespace {
+	// Files are read and decoded by one worker thread, finished objects are created on the main thread when
+	// events are pumped, so nothing touching Lua, GX state or the texture cache ever runs on the worker
+	enum class JobType {
+		font,
+		texture,
+		screenshot
+	};
+
+	struct Job {
+		unsigned int id;
+		JobType type;
+		bool cancelled;
+
+		std::string filename;
+		std::string format;
+		bool mipmaps;
+		bool cached; // Texture already in the cache when queued, the job only keeps its place in line
+		unsigned int fontSize;
+		unsigned int width, height;
+
+		// Results
+		love::graphics::LoadedTexture texture;
+		void *data;
+		int dataSize;
+		std::string error;
+	};
+
+	std::deque<Job *> queuedJobs;
+	std::vector<Job *> finishedJobs;
+	Job *runningJob = nullptr;
+	unsigned int nextJobID = 1;
+
+#if defined(GEKKO)
+	constexpr unsigned char workerPriority = LWP_PRIO_NORMAL - 16; // Below the main thread, runs while it waits for vsync
+	constexpr unsigned int workerStackSize = 64 * 1024; // libpng keeps a sizeable jmp_buf and row state on the stack
+
+	lwp_t worker = LWP_THREAD_NULL;
+	mutex_t jobMutex;
+	cond_t jobCondition;
+
+	void lockJobs() { LWP_MutexLock(jobMutex); }
+	void unlockJobs() { LWP_MutexUnlock(jobMutex); }
+	void waitForJobs() { LWP_CondWait(jobCondition, jobMutex); }
+	void signalJobs() { LWP_CondSignal(jobCondition); }
+#else // Host stand-in, so job ordering and cancellation can be exercised off the console
+	pthread_t worker;
+	pthread_mutex_t jobMutex = PTHREAD_MUTEX_INITIALIZER;
+	pthread_cond_t jobCondition = PTHREAD_COND_INITIALIZER;
+
+	void lockJobs() { pthread_mutex_lock(&jobMutex); }
+	void unlockJobs() { pthread_mutex_unlock(&jobMutex); }
+	void waitForJobs() { pthread_cond_wait(&jobCondition, &jobMutex); }
+	void signalJobs() { pthread_cond_signal(&jobCondition); }
+#endif // GEKKO
+
+	void runJob(Job *job) {
+		try {
+			switch (job->type) {
+				case JobType::font: // Throws for files that can't be read, so the job fails instead of Font getting garbage
+					love::filesystem::getFileData(job->filename.c_str(), job->data, job->dataSize);
+					break;
+				case JobType::texture:
+					if (!job->cached) job->texture = love::graphics::loadTextureFile(job->filename.c_str(), job->format, job->mipmaps);
+					break;
+				case JobType::screenshot:
+					love::graphics::writePNG(static_cast<unsigned char *>(job->data), job->width, job->height, false, "save/" + job->filename);
+					break;
+			}
+		} catch (const std::exception &exception) {
+			job->error = exception.what();
+		}
+	}
+
+	void *work(void *) {
+		while (true) {
+			lockJobs();
+
+			while (queuedJobs.empty()) waitForJobs();
+
+			runningJob = queuedJobs.front();
+			queuedJobs.pop_front();
+
+			unlockJobs();
+
+			runJob(runningJob);
+
+			lockJobs();
+
+			finishedJobs.push_back(runningJob);
+			runningJob = nullptr;
+
+			unlockJobs();
+		}
+
+		return nullptr;
+	}
+
+	// Frees whatever a job produced without handing it to Lua
+	void discardJob(Job *job) {
+		if (job->texture.texture != nullptr) GRRLIB_FreeTexture(job->texture.texture);
+		std::free(job->data);
+
+		delete job;
+	}
+
+	Job *newJob(JobType type, const char *filename) {
+		Job *job = new Job();
+
+		job->id = nextJobID++;
+		job->type = type;
+		job->cancelled = false;
+		job->filename = filename;
+		job->mipmaps = false;
+		job->cached = false;
+		job->fontSize = 0;
+		job->width = 0;
+		job->height = 0;
+		job->texture.texture = nullptr;
+		job->data = nullptr;
+		job->dataSize = 0;
+
+		return job;
+	}
+
+	unsigned int queueJob(Job *job) {
+		lockJobs();
+
+		queuedJobs.push_back(job);
+		signalJobs();
+
+		unlockJobs();
+
+		return job->id;
+	}
+}
+
+void init() {
+#if defined(GEKKO)
+	LWP_MutexInit(&jobMutex, false);
+	LWP_CondInit(&jobCondition);
+	LWP_CreateThread(&worker, work, nullptr, nullptr, workerStackSize, workerPriority);
+#else
+	pthread_create(&worker, nullptr, work, nullptr);
+#endif // GEKKO
+}
+
+// Turns finished jobs into objects and "loaded" events, in the order they were queued
+void update(sol::this_state s) {
+	std::vector<Job *> jobs;
+
+	lockJobs();
+
+	jobs.swap(finishedJobs);
+
+	unlockJobs();
+
+	for (Job *job : jobs) {
+		if (job->cancelled) {
+			discardJob(job);
+
+			continue;
+		}
+
+		if (job->type == JobType::screenshot) {
+			love::event::pushEvent(s, "screenshot", sol::make_object(s, job->filename), job->error.empty() ? sol::lua_nil : sol::make_object(s, job->error));
+
+			discardJob(job);
+
+			continue;
+		}
+
+		if (!job->error.empty()) {
+			love::event::pushEvent(s, "loaded", sol::make_object(s, job->id), sol::lua_nil, sol::make_object(s, job->error));
+		} else if (job->type == JobType::font) {
+			love::event::pushEvent(s, "loaded", sol::make_object(s, job->id), sol::make_object<love::graphics::Font>(s, job->data, job->dataSize, job->fontSize));
+		} else if (job->texture.texture == nullptr) { // Was already cached when queued
+			love::event::pushEvent(s, "loaded", sol::make_object(s, job->id), sol::make_object<love::graphics::Texture>(s, job->filename.c_str(), job->format, job->mipmaps));
+		} else {
+			love::event::pushEvent(s, "loaded", sol::make_object(s, job->id), sol::make_object<love::graphics::Texture>(s, job->texture));
+		}
+
+		job->texture.texture = nullptr; // Owned by the new object now
+		job->data = nullptr;
+
+		discardJob(job);
+	}
+}
+
+// Encodes tiled RGBA8 pixels to save/filename on the worker, taking ownership of them. A "screenshot" event
+// follows once the file is written.
+void saveScreenshot(void *pixels, unsigned int width, unsigned int height, const std::string &filename) {
+	Job *job = newJob(JobType::screenshot, filename.c_str());
+
+	job->data = pixels;
+	job->width = width;
+	job->height = height;
+
+	queueJob(job);
+}
+
+namespace module {
+
+// Async loading functions, each returns the ID its "loaded" event will carry
+unsigned int newFont(const char *filename, unsigned int size) {
+	Job *job = newJob(JobType::font, filename);
+
+	job->fontSize = size;
+
+	return queueJob(job);
+}
+unsigned int newTexture(const char *filename, const std::string &format, bool mipmaps) {
+	Job *job = newJob(JobType::texture, filename);
+
+	job->format = format;
+	job->mipmaps = mipmaps;
+	job->cached = love::graphics::isTextureCached(filename, format, mipmaps); // Nothing to decode, but still delivered in order
+
+	return queueJob(job);
+}
+
+// Queue functions
+bool cancel(unsigned int id) { // Drops a job, or its result if it is already being loaded
+	bool found = false;
+
+	lockJobs();
+
+	for (auto job = queuedJobs.begin(); job != queuedJobs.end(); ++job) {
+		if ((*job)->id == id) {
+			discardJob(*job);
+			queuedJobs.erase(job);
+
+			found = true;
+
+			break;
+		}
+	}
+
+	if (!found && runningJob != nullptr && runningJob->id == id && !runningJob->cancelled) {
+		runningJob->cancelled = true;
+		found = true;
+	}
+
+	for (Job *job : finishedJobs) {
+		if (!found && job->id == id && !job->cancelled) {
+			job->cancelled = true;
+			found = true;
+		}
+	}
+
+	unlockJobs();
+
+	return found;
+}
+unsigned int getPendingCount() {
+	unsigned int count;
+
+	lockJobs();
+
+	count = queuedJobs.size() + finishedJobs.size() + (runningJob != nullptr ? 1 : 0);
+
+	unlockJobs();
+
+	return count;
+}
+
+} // module
+} // loader
+} // love
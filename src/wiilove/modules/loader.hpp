@@ -0,0 +1,47 @@
+/* WiiLÖVE loader module
+ *
+ * This file is part of WiiLÖVE.
+ *
+ * Copyright (C) 2022  HTV04
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+// Libraries
+#include <sol/sol.hpp>
+#include <string>
+
+namespace love {
+namespace loader {
+
+void init();
+void update(sol::this_state s);
+
+void saveScreenshot(void *pixels, unsigned int width, unsigned int height, const std::string &filename);
+
+namespace module {
+
+unsigned int newFont(const char *filename, unsigned int size);
+unsigned int newTexture(const char *filename, const std::string &format, bool mipmaps);
+
+bool cancel(unsigned int id);
+unsigned int getPendingCount();
+
+} // module
+} // loader
+} // love
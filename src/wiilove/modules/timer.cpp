@@ -55,7 +55,7 @@ double getFPS() { return fps; }
 double getTime() { return ticks_to_millisecs(gettime()); }
 
 // Actions
-void sleep(int ms) { usleep(ms); }
+void sleep(int ms) { usleep(ms * 1000); } // usleep takes microseconds
 double step() { // Update timer
 	unsigned long long curTime = gettime();
 
@@ -0,0 +1,336 @@
+/* WiiLÖVE baked text test
+ *
+ * This file is part of WiiLÖVE.
+ *
+ * Copyright (C) 2022  HTV04
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+// Host test of Font:bake. Each bake is compared pixel for pixel against a reference drawn one glyph at a time with
+// FreeTypeGX's own placement rules, on lines broken greedily word by word. It covers unwrapped text in i8 and ia4, and
+// wrapped paragraphs in every alignment. The Texture a bake returns is replaced by one that keeps the ImageData it was
+// made from.
+//
+// Usage:
+//   baketest <font>  (prints each case and exits with 1 if any failed)
+
+// Libraries
+#include <FreeTypeGX.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <stdexcept>
+#include "open-sans_ttf.h"
+
+// Classes
+#include "classes/graphics/font.hpp"
+#include "classes/graphics/imagedata.hpp"
+#include "classes/graphics/texture.hpp"
+
+// Modules
+#include "modules/filesystem.hpp"
+#include "modules/graphics.hpp"
+
+namespace {
+	constexpr unsigned int pointSize = 16;
+
+	love::graphics::ImageData *baked = nullptr;
+
+	struct Line {
+		std::wstring text;
+		bool paragraphEnd;
+	};
+
+	// Coverage of the reference, one byte per pixel
+	struct Canvas {
+		int width, height;
+		std::vector<unsigned char> pixels;
+
+		unsigned char at(int x, int y) const {
+			return x < width && y < height ? pixels[y * width + x] : 0;
+		}
+	};
+
+	bool check(const char *name, bool passed) {
+		std::printf("%s: %s\n", passed ? "ok" : "FAILED", name);
+
+		return passed;
+	}
+
+	bool readFile(const char *path, std::vector<uint8_t> &data) {
+		FILE *file = std::fopen(path, "rb");
+
+		if (file == nullptr) return false;
+
+		std::fseek(file, 0, SEEK_END);
+		data.resize(std::ftell(file));
+		std::fseek(file, 0, SEEK_SET);
+
+		bool read = std::fread(data.data(), 1, data.size(), file) == data.size();
+
+		std::fclose(file);
+
+		return read && !data.empty();
+	}
+
+	int measure(FreeTypeGX &face, const std::wstring &text) {
+		ftgxGlyph previous = {nullptr, nullptr};
+		int width = 0;
+
+		for (wchar_t character : text) {
+			ftgxGlyph glyph = face.resolveCharacter(character);
+
+			if (glyph.charData == nullptr) continue;
+
+			width += face.getKerning(previous, glyph) + glyph.charData->glyphAdvanceX;
+			previous = glyph;
+		}
+
+		return width;
+	}
+
+	// Whole words while they fit, words wider than a line split before the first character that doesn't
+	std::vector<Line> breakLines(FreeTypeGX &face, const std::wstring &text, int wrap) {
+		std::vector<Line> lines;
+		size_t paragraphStart = 0;
+
+		while (paragraphStart <= text.size()) {
+			size_t paragraphEnd = std::min(text.find(L'\n', paragraphStart), text.size());
+			std::wstring paragraph = text.substr(paragraphStart, paragraphEnd - paragraphStart), line;
+			size_t wordStart = 0;
+			bool first = true;
+
+			while (wrap > 0 && wordStart <= paragraph.size()) {
+				size_t wordEnd = std::min(paragraph.find(L' ', wordStart), paragraph.size());
+				std::wstring word = paragraph.substr(wordStart, wordEnd - wordStart);
+
+				if (first || measure(face, line + L" " + word) <= wrap) {
+					line = first ? word : line + L" " + word;
+				} else {
+					lines.push_back({line, false});
+					line = word;
+				}
+
+				while (measure(face, line) > wrap && line.size() > 1) {
+					size_t fits = 1;
+
+					while (measure(face, line.substr(0, fits + 1)) <= wrap) fits++;
+
+					lines.push_back({line.substr(0, fits), false});
+					line.erase(0, fits);
+				}
+
+				first = false;
+				wordStart = wordEnd + 1;
+			}
+
+			lines.push_back({wrap > 0 ? line : paragraph, true});
+			paragraphStart = paragraphEnd + 1;
+		}
+
+		return lines;
+	}
+
+	// Glyphs go where drawText puts them, shifted by the alignment, and overlapping coverage keeps the larger value
+	Canvas drawReference(FreeTypeGX &face, const std::wstring &text, int wrap, const std::string &align) {
+		std::vector<Line> lines = breakLines(face, text, wrap);
+		int lineHeight = face.getLineHeight(), layoutWidth = wrap;
+
+		if (wrap <= 0) {
+			layoutWidth = 0;
+
+			for (const Line &line : lines) layoutWidth = std::max(layoutWidth, measure(face, line.text));
+		}
+
+		Canvas canvas = {wrap > 0 ? wrap : layoutWidth + lineHeight, static_cast<int>(lines.size() + 1) * lineHeight, {}};
+
+		canvas.pixels.assign(canvas.width * canvas.height, 0);
+
+		for (size_t i = 0; i < lines.size(); i++) {
+			const Line &line = lines[i];
+			int extra = layoutWidth - measure(face, line.text);
+			int spaces = std::count(line.text.begin(), line.text.end(), L' ');
+			float x = 0.0f;
+			ftgxGlyph previous = {nullptr, nullptr};
+
+			if (align == "center") x = extra / 2;
+			else if (align == "right") x = extra;
+
+			for (wchar_t character : line.text) {
+				ftgxGlyph glyph = face.resolveCharacter(character);
+
+				if (glyph.charData == nullptr) continue;
+
+				int kerning = face.getKerning(previous, glyph), top;
+				FT_Bitmap *bitmap = character == L' ' ? nullptr : face.renderGlyph(glyph, &top);
+
+				for (unsigned int row = 0; bitmap != nullptr && row < bitmap->rows; row++) {
+					for (unsigned int column = 0; column < bitmap->width; column++) {
+						int pixelX = static_cast<int>(x) + kerning + column, pixelY = (i + 1) * lineHeight - top + row;
+
+						if (pixelX < 0 || pixelY < 0 || pixelX >= canvas.width || pixelY >= canvas.height) continue;
+
+						unsigned char &pixel = canvas.pixels[pixelY * canvas.width + pixelX];
+
+						pixel = std::max(pixel, bitmap->buffer[row * bitmap->pitch + column]);
+					}
+				}
+
+				x += kerning + glyph.charData->glyphAdvanceX;
+				previous = glyph;
+
+				if (character == L' ' && align == "justify" && !line.paragraphEnd) x += static_cast<float>(extra) / spaces;
+			}
+		}
+
+		return canvas;
+	}
+
+	// Every pixel of the bake, and every covered pixel of the reference, has to match
+	bool matches(const Canvas &reference, bool ia4) {
+		int width = std::max<int>(reference.width, baked->width), height = std::max<int>(reference.height, baked->height);
+
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				unsigned char expected = reference.at(x, y), intensity = 255, alpha = 0;
+
+				if (x < static_cast<int>(baked->width) && y < static_cast<int>(baked->height)) {
+					std::tie(intensity, std::ignore, std::ignore, alpha) = baked->getPixel(x, y);
+				}
+
+				if (ia4 ? intensity != 255 || alpha != (expected >> 4) * 17 : alpha != expected) return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+// Stand-ins for what Font and ImageData call
+uint32_t GX_GetTexBufferSize(uint16_t width, uint16_t height, uint32_t format, uint8_t, uint8_t) {
+	unsigned int tileWidth = format == GX_TF_RGBA8 || format == GX_TF_IA8 || format == GX_TF_RGB565 || format == GX_TF_RGB5A3 ? 4 : 8;
+	unsigned int tileHeight = format == GX_TF_I4 || format == GX_TF_CMPR ? 8 : 4;
+
+	return ((width + tileWidth - 1) / tileWidth) * ((height + tileHeight - 1) / tileHeight) * (format == GX_TF_RGBA8 ? 64 : 32);
+}
+
+const uint8_t open_sans_ttf[] = {0};
+const uint32_t open_sans_ttf_size = 0;
+
+namespace love {
+namespace filesystem {
+
+void getFileData(const char *filename, void *&, int &) {
+	throw std::runtime_error(std::string("No files on the host: ") + filename);
+}
+
+} // filesystem
+
+namespace graphics {
+
+void waitForFrame() {}
+bool isOnScreen(const float (&)[4][2]) { return false; }
+void batchQuad(const Texture &, const float (&)[4][2], float, float, float, float, unsigned int) {}
+
+bool getTextureFormat(const std::string &name, unsigned char &format) {
+	if (name == "i8") format = GX_TF_I8;
+	else if (name == "ia4") format = GX_TF_IA4;
+	else return false;
+
+	return true;
+}
+std::string getTextureFormatName(unsigned char format) {
+	return format == GX_TF_I8 ? "i8" : "ia4";
+}
+
+Texture::Texture(const char *filename) {
+	throw std::runtime_error(std::string("No files on the host: ") + filename);
+}
+Texture::Texture(const ImageData &imageData) : instances(new int(1)), residency(nullptr), texture(nullptr), format(imageData.format), maxLOD(0), size(0) {
+	delete baked;
+
+	baked = new ImageData(imageData);
+}
+Texture::Texture(const Texture &other) : instances(other.instances), residency(nullptr), texture(nullptr), format(other.format), maxLOD(0), size(0) {
+	(*instances)++;
+}
+void Texture::makeResident() const {}
+Texture::~Texture() {
+	if (--(*instances) == 0) delete instances;
+}
+
+} // graphics
+} // love
+
+int main(int argc, char **argv) {
+	std::vector<uint8_t> fontData;
+
+	if (argc != 2) {
+		std::fprintf(stderr, "usage: baketest <font>\n");
+
+		return 1;
+	}
+	if (!readFile(argv[1], fontData)) {
+		std::fprintf(stderr, "baketest: could not read %s\n", argv[1]);
+
+		return 1;
+	}
+
+	void *data = std::malloc(fontData.size()); // Font takes ownership of its data
+
+	std::copy(fontData.begin(), fontData.end(), static_cast<uint8_t *>(data));
+
+	love::graphics::Font font(data, fontData.size(), pointSize);
+	FreeTypeGX reference;
+	bool passed = true;
+
+	reference.loadFont(fontData.data(), fontData.size(), pointSize);
+
+	{ // Unwrapped, with kerning pairs, descenders and accents
+		std::wstring text = L"AVAWA Typo, kerning! ÅÉ gjpqy\nSecond line";
+
+		font.bake(text);
+		passed &= check("i8", matches(drawReference(reference, text, 0, "left"), false));
+
+		font.bake3(text, 0, "right", "ia4");
+		passed &= check("ia4", matches(drawReference(reference, text, 0, "right"), true));
+	}
+
+	{ // Wrapped paragraphs, including a word wider than a line
+		std::wstring text = L"The quick brown fox jumps over the lazy dog and keeps on running\nShort\n"
+			L"Anextremelylongwordthatcannotfitononeline and some more words to wrap";
+
+		for (int wrap : {120, 200}) {
+			for (const char *align : {"left", "center", "right", "justify"}) {
+				std::string name = std::string(align) + " wrapped at " + std::to_string(wrap);
+
+				font.bake2(text, wrap, align);
+				passed &= check(name.c_str(), matches(drawReference(reference, text, wrap, align), false));
+			}
+		}
+
+		font.bake3(text, 150, "justify", "ia4");
+		passed &= check("ia4 justify wrapped at 150", matches(drawReference(reference, text, 150, "justify"), true));
+	}
+
+	delete baked;
+
+	return passed ? 0 : 1;
+}
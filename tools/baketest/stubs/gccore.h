@@ -0,0 +1,7 @@
+// Host stand-in for libogc, the video header only needs the GX and matrix types
+#pragma once
+
+#include <ogc/gx.h>
+#include <ogc/gu.h>
+
+inline void DCFlushRange(void *, uint32_t) {}
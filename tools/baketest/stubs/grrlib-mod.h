@@ -0,0 +1,32 @@
+// Host stand-in for the parts of GRRLIB-mod Font, ImageData and FreeTypeGX use. Drawing does nothing.
+#pragma once
+
+#include <gccore.h>
+
+typedef struct {
+	float x, y, width, height;
+	unsigned int textureWidth, textureHeight;
+} GRRLIB_texturePart;
+
+typedef struct {
+	unsigned int width, height;
+	GRRLIB_texturePart part;
+	void *data;
+} GRRLIB_texture;
+
+typedef struct {
+	Mtx mtx;
+} GRRLIB_matrix;
+
+typedef struct {
+	unsigned int color;
+} GRRLIB_drawSettings;
+
+inline GRRLIB_drawSettings GRRLIB_Settings = {0xffffffff};
+
+inline GRRLIB_matrix GRRLIB_GetMatrix() { return {}; }
+inline void GRRLIB_SetMatrix(const GRRLIB_matrix *) {}
+inline void GRRLIB_Translate(float, float) {}
+inline void GRRLIB_Scale(float, float) {}
+inline void GRRLIB_Rotate(float) {}
+inline void GRRLIB_Transform(float, float, float, float, float) {}
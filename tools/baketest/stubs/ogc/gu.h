@@ -0,0 +1,4 @@
+// Host stand-in for the libogc matrix type
+#pragma once
+
+typedef float Mtx[3][4];
@@ -0,0 +1,7 @@
+// Host stand-in for the embedded default font, the test loads its font from a file
+#pragma once
+
+#include <cstdint>
+
+extern const uint8_t open_sans_ttf[];
+extern const uint32_t open_sans_ttf_size;
@@ -0,0 +1,139 @@
+/* WiiLÖVE font fallback benchmark
+ *
+ * This file is part of WiiLÖVE.
+ *
+ * Copyright (C) 2022  HTV04
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+// Host benchmark of FreeTypeGX's fallback resolution on a mixed Latin and CJK paragraph. The primary face has no CJK
+// glyphs, so every CJK character has to come from the fallback. It checks that each character resolves to the face
+// that has it, then times getWidth over the paragraph with kerning on and off. Drawing is stubbed out, so only the
+// resolution, kerning and measurement work is timed. Host timings show relative costs, not the Wii's.
+//
+// Usage:
+//   fontbench <primary font> <CJK font>  (prints each check and timing, exits with 1 if a check failed)
+
+// Libraries
+#include <FreeTypeGX.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+	constexpr unsigned int pointSize = 16;
+	constexpr unsigned int runs = 200;
+
+	const std::wstring line = L"WiiLÖVE draws 日本語の文章を表示するテストです and 中文字体回退测试 next to Latin text, 한국어 too.\n";
+
+	bool check(const char *name, bool passed) {
+		std::printf("%s: %s\n", passed ? "ok" : "FAILED", name);
+
+		return passed;
+	}
+
+	bool readFile(const char *path, std::vector<uint8_t> &data) {
+		FILE *file = std::fopen(path, "rb");
+
+		if (file == nullptr) return false;
+
+		std::fseek(file, 0, SEEK_END);
+		data.resize(std::ftell(file));
+		std::fseek(file, 0, SEEK_SET);
+
+		bool read = std::fread(data.data(), 1, data.size(), file) == data.size();
+
+		std::fclose(file);
+
+		return read && !data.empty();
+	}
+
+	bool isCJK(wchar_t character) {
+		return (character >= 0x3000 && character <= 0x9fff) || (character >= 0xac00 && character <= 0xd7af);
+	}
+
+	// Microseconds per getWidth call over the paragraph
+	double timeWidth(FreeTypeGX &face, const std::wstring &text, int &width) {
+		auto start = std::chrono::steady_clock::now();
+
+		for (unsigned int run = 0; run < runs; run++) width = face.getWidth(text.c_str());
+
+		return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / runs;
+	}
+}
+
+int main(int argc, char **argv) {
+	std::vector<uint8_t> primaryData, fallbackData;
+
+	if (argc != 3) {
+		std::fprintf(stderr, "usage: fontbench <primary font> <CJK font>\n");
+
+		return 1;
+	}
+	if (!readFile(argv[1], primaryData) || !readFile(argv[2], fallbackData)) {
+		std::fprintf(stderr, "fontbench: could not read the fonts\n");
+
+		return 1;
+	}
+
+	FreeTypeGX primary, fallback;
+	std::wstring paragraph;
+	bool passed = true;
+
+	primary.loadFont(primaryData.data(), primaryData.size(), pointSize);
+	fallback.loadFont(fallbackData.data(), fallbackData.size(), pointSize);
+
+	for (unsigned int i = 0; i < 16; i++) paragraph += line;
+
+	primary.setFallbacks({&fallback});
+
+	{ // With the fallback set, every character resolves, to the face that has it
+		bool resolved = true, fromFallback = true, fromPrimary = true;
+
+		for (wchar_t character : line) {
+			if (character == L'\n') continue;
+
+			ftgxGlyph glyph = primary.resolveCharacter(character);
+
+			resolved &= glyph.charData != nullptr;
+			if (isCJK(character)) fromFallback &= glyph.face == &fallback;
+			else fromPrimary &= glyph.face == &primary;
+		}
+
+		passed &= check("every character resolves", resolved);
+		passed &= check("CJK characters come from the fallback", fromFallback);
+		passed &= check("Latin characters stay on the primary face", fromPrimary);
+	}
+
+	int kerned = 0, unkerned = 0;
+
+	primary.getWidth(paragraph.c_str()); // Caches every glyph before timing
+
+	double kernedTime = timeWidth(primary, paragraph, kerned);
+
+	primary.setKerningEnabled(false);
+
+	double unkernedTime = timeWidth(primary, paragraph, unkerned);
+
+	passed &= check("paragraph has a width", kerned > 0 && unkerned > 0);
+
+	std::printf("%zu characters, %u px: getWidth %.1f us with kerning, %.1f us without\n", paragraph.size(), pointSize,
+		kernedTime, unkernedTime);
+
+	return passed ? 0 : 1;
+}
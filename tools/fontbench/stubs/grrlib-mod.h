@@ -0,0 +1,21 @@
+// Host stand-in for the parts of GRRLIB-mod FreeTypeGX draws with, all of which do nothing
+#pragma once
+
+#include <ogc/gx.h>
+
+typedef struct {
+	float mtx[3][4];
+} GRRLIB_matrix;
+
+typedef struct {
+	unsigned int color;
+} GRRLIB_drawSettings;
+
+inline GRRLIB_drawSettings GRRLIB_Settings = {0xffffffff};
+
+inline GRRLIB_matrix GRRLIB_GetMatrix() { return {}; }
+inline void GRRLIB_SetMatrix(const GRRLIB_matrix *) {}
+inline void GRRLIB_Translate(float, float) {}
+inline void GRRLIB_Scale(float, float) {}
+inline void GRRLIB_Rotate(float) {}
+inline void GRRLIB_Transform(float, float, float, float, float) {}
@@ -0,0 +1,25 @@
+// Host stand-in for the parts of libogc's GX FreeTypeGX draws with, all of which do nothing
+#pragma once
+
+#include <cstdint>
+
+#define GX_FALSE 0
+
+enum { GX_TF_I4 = 0x0, GX_TF_I8 = 0x1, GX_TF_IA4 = 0x2, GX_TF_IA8 = 0x3, GX_TF_RGB565 = 0x4, GX_TF_RGB5A3 = 0x5, GX_TF_RGBA8 = 0x6 };
+enum { GX_CLAMP = 0, GX_TEXMAP0 = 0, GX_TEVSTAGE0 = 0, GX_VTXFMT0 = 0 };
+enum { GX_MODULATE = 0, GX_PASSCLR = 4 };
+enum { GX_NONE = 0, GX_DIRECT = 1, GX_VA_TEX0 = 13, GX_QUADS = 0x80 };
+
+typedef struct {
+	uint32_t val[8];
+} GXTexObj;
+
+inline void GX_InitTexObj(GXTexObj *, void *, uint16_t, uint16_t, uint8_t, uint8_t, uint8_t, uint8_t) {}
+inline void GX_LoadTexObj(GXTexObj *, uint8_t) {}
+inline void GX_SetTevOp(uint8_t, uint8_t) {}
+inline void GX_SetVtxDesc(uint8_t, uint8_t) {}
+inline void GX_Begin(uint8_t, uint8_t, uint16_t) {}
+inline void GX_End() {}
+inline void GX_Position3f32(float, float, float) {}
+inline void GX_Color1u32(uint32_t) {}
+inline void GX_TexCoord2f32(float, float) {}
@@ -0,0 +1,242 @@
+/* WiiLÖVE loader test
+ *
+ * This file is part of WiiLÖVE.
+ *
+ * Copyright (C) 2022  HTV04
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+// Host test of love.loader: results arrive in submission order, including textures that were already cached, and
+// cancelled jobs never produce events, wherever they were when cancelled. The loader runs on its pthread stand-in;
+// everything it calls into is replaced below, and files named "slow*" block the worker until the test releases them.
+//
+// Usage:
+//   loadertest  (prints each case and exits with 1 if any failed)
+
+// Libraries
+#include <sol/sol.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdexcept>
+
+// Classes
+#include "classes/graphics/font.hpp"
+#include "classes/graphics/imagedata.hpp"
+#include "classes/graphics/texture.hpp"
+
+// Modules
+#include "modules/event.hpp"
+#include "modules/filesystem.hpp"
+#include "modules/loader.hpp"
+
+namespace {
+	struct Event {
+		std::string name;
+		unsigned int id;
+		bool failed;
+	};
+
+	std::vector<Event> events;
+
+	// Each slow file blocks the worker until the test hands out a permit for it
+	std::mutex gateMutex;
+	std::condition_variable gateCondition;
+	unsigned int blocks = 0, seenBlocks = 0;
+	unsigned int permits = 0;
+
+	void blockWorker() {
+		std::unique_lock<std::mutex> lock(gateMutex);
+
+		blocks++;
+		gateCondition.notify_all();
+		gateCondition.wait(lock, [] { return permits > 0; });
+		permits--;
+	}
+	void waitForBlockedWorker() {
+		std::unique_lock<std::mutex> lock(gateMutex);
+
+		gateCondition.wait(lock, [] { return blocks > seenBlocks; });
+		seenBlocks++;
+	}
+	void releaseWorker() {
+		std::lock_guard<std::mutex> lock(gateMutex);
+
+		permits++;
+		gateCondition.notify_all();
+	}
+
+	// Pumps like love.event.pump until nothing is pending
+	void drain(lua_State *L) {
+		while (love::loader::module::getPendingCount() > 0) {
+			love::loader::update(sol::this_state(L));
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		love::loader::update(sol::this_state(L));
+	}
+
+	bool check(const char *name, bool passed) {
+		std::printf("%s: %s\n", passed ? "ok" : "FAILED", name);
+
+		return passed;
+	}
+}
+
+// Stand-ins for what the loader calls
+void GRRLIB_FreeTexture(GRRLIB_texture *texture) { delete texture; }
+
+namespace love {
+namespace event {
+
+void pushEvent(lua_State *, const char *eventName, sol::object value1, sol::object value2, sol::object, sol::object, sol::object, sol::object) {
+	events.push_back({eventName, value1.is<unsigned int>() ? value1.as<unsigned int>() : 0, value2 == sol::lua_nil});
+}
+
+} // event
+
+namespace filesystem {
+
+void getFileData(const char *filename, void *&data, int &size) {
+	if (std::string(filename).compare(0, 7, "missing") == 0) { throw std::runtime_error("Could not open " + std::string(filename)); }
+	if (std::string(filename).compare(0, 4, "slow") == 0) blockWorker();
+
+	size = 4;
+	data = std::malloc(size);
+}
+
+} // filesystem
+
+namespace graphics {
+
+LoadedTexture loadTextureFile(const char *filename, const std::string &format, bool) {
+	if (std::string(filename).compare(0, 4, "slow") == 0) blockWorker();
+
+	return {std::string(filename) + ":" + format, new GRRLIB_texture{1, 1, nullptr}, 0, 0};
+}
+bool isTextureCached(const char *filename, const std::string &, bool) {
+	return std::string(filename).compare(0, 6, "cached") == 0;
+}
+void writePNG(const unsigned char *, unsigned int, unsigned int, bool, const std::string &) {}
+
+Texture::Texture(const LoadedTexture &loaded) : instances(new int(1)), residency(nullptr), texture(loaded.texture), format(0), maxLOD(0), size(0) {}
+Texture::Texture(const char *, const std::string &, bool) : instances(new int(1)), residency(nullptr), texture(new GRRLIB_texture{1, 1, nullptr}), format(0), maxLOD(0), size(0) {}
+Texture::Texture(const Texture &other) : instances(other.instances), residency(nullptr), texture(other.texture), format(0), maxLOD(0), size(0) {
+	(*instances)++;
+}
+Texture::~Texture() {
+	if (--(*instances) == 0) {
+		delete texture;
+		delete instances;
+	}
+}
+
+Font::Font(void *data, int, unsigned int) : instances(new int(1)), data(data), imageFont(nullptr), fontSystem(nullptr) {}
+Font::Font(const Font &other) : instances(other.instances), data(other.data), imageFont(nullptr), fontSystem(nullptr) {
+	(*instances)++;
+}
+Font::~Font() {
+	if (--(*instances) == 0) {
+		std::free(data);
+		delete instances;
+	}
+}
+
+} // graphics
+} // love
+
+int main() {
+	lua_State *L = luaL_newstate();
+	bool passed = true;
+
+	love::loader::init();
+
+	{ // A cached texture queued behind a slow one is delivered after it
+		events.clear();
+
+		unsigned int slow = love::loader::module::newTexture("slow.png", "rgba8", false);
+		unsigned int cached = love::loader::module::newTexture("cached.png", "rgba8", false);
+
+		waitForBlockedWorker();
+		love::loader::update(sol::this_state(L));
+
+		passed &= check("nothing delivered while the first job decodes", events.empty());
+
+		releaseWorker();
+		drain(L);
+
+		passed &= check("cached texture after the one queued before it", events.size() == 2 && events[0].id == slow && events[1].id == cached);
+	}
+
+	{ // Mixed job types keep their order too
+		events.clear();
+
+		unsigned int font = love::loader::module::newFont("slow.ttf", 12);
+		unsigned int texture = love::loader::module::newTexture("a.png", "rgba8", false);
+		unsigned int cached = love::loader::module::newTexture("cached.png", "rgba8", false);
+
+		waitForBlockedWorker();
+		releaseWorker();
+		drain(L);
+
+		passed &= check("fonts and textures in submission order", events.size() == 3 && events[0].id == font && events[1].id == texture && events[2].id == cached);
+	}
+
+	{ // Cancelling a queued job, the running one and one already finished
+		events.clear();
+
+		unsigned int running = love::loader::module::newTexture("slow.png", "rgba8", false);
+		unsigned int queued = love::loader::module::newTexture("b.png", "rgba8", false);
+		unsigned int finished = love::loader::module::newTexture("c.png", "rgba8", false);
+		unsigned int last = love::loader::module::newTexture("slow.png", "rgba8", false); // Holds the worker once c.png is done
+
+		waitForBlockedWorker();
+
+		passed &= check("cancel a queued job", love::loader::module::cancel(queued));
+		passed &= check("cancel the running job", love::loader::module::cancel(running));
+		passed &= check("cancel it only once", !love::loader::module::cancel(running));
+
+		releaseWorker();
+		waitForBlockedWorker();
+
+		passed &= check("cancel a finished job before it's delivered", love::loader::module::cancel(finished));
+
+		releaseWorker();
+		drain(L);
+
+		passed &= check("cancelled jobs deliver nothing", events.size() == 1 && events[0].id == last);
+		passed &= check("unknown IDs aren't found", !love::loader::module::cancel(last + 100));
+	}
+
+	{ // Errors arrive as loaded(id, nil, err)
+		events.clear();
+		unsigned int missing = love::loader::module::newFont("missing.ttf", 12);
+
+		drain(L);
+
+		passed &= check("unreadable font fails its job", events.size() == 1 && events[0].id == missing && events[0].failed);
+	}
+
+	lua_close(L);
+
+	return passed ? 0 : 1;
+}
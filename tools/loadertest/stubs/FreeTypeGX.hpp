@@ -0,0 +1,4 @@
+// Host stand-in, the loader only passes Font objects around
+#pragma once
+
+class FreeTypeGX;
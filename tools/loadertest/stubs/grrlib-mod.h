@@ -0,0 +1,11 @@
+// Host stand-in for the parts of GRRLIB-mod the loader's headers name
+#pragma once
+
+typedef float Mtx[3][4];
+
+typedef struct {
+	unsigned int width, height;
+	void *data;
+} GRRLIB_texture;
+
+void GRRLIB_FreeTexture(GRRLIB_texture *texture);
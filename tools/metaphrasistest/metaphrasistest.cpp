@@ -0,0 +1,343 @@
+/* WiiLÖVE Metaphrasis test
+ *
+ * This file is part of WiiLÖVE.
+ *
+ * Copyright (C) 2022  HTV04
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+// Host test and benchmark of the Metaphrasis texture converters. Every tiled format is checked byte for byte against
+// a plain per-pixel reference of GX's layout (32-byte tiles, big-endian texels). CMPR is checked against its block
+// encoder placed in GX's tile order, and decoded back from blocks it holds exactly. Every converter is timed at each
+// size. The mipmap box filter is checked against a per-channel reference and, fed one tile band at a time like the
+// streaming PNG loader, against itself on the whole image.
+//
+// Usage:
+//   metaphrasistest  (prints each case and the timings, exits with 1 if any case failed)
+
+// Libraries
+#include <Metaphrasis.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+	constexpr uint32_t guard = 0xdeadbeef; // Fills the word after the output, to catch overruns
+
+	enum class Texel {
+		i4,
+		i8,
+		ia4,
+		ia8,
+		rgb565,
+		rgb5a3,
+		rgba8
+	};
+
+	struct Format {
+		const char *name;
+		Texel texel;
+		unsigned int tileWidth, tileHeight;
+		unsigned int bitsPerPixel;
+		void (*convert)(uint32_t *, uint16_t, uint16_t, uint32_t *);
+	};
+
+	const Format formats[] = {
+		{"i4", Texel::i4, 8, 8, 4, Metaphrasis::convertBufferToI4},
+		{"i8", Texel::i8, 8, 4, 8, Metaphrasis::convertBufferToI8},
+		{"ia4", Texel::ia4, 8, 4, 8, Metaphrasis::convertBufferToIA4},
+		{"ia8", Texel::ia8, 4, 4, 16, Metaphrasis::convertBufferToIA8},
+		{"rgb565", Texel::rgb565, 4, 4, 16, Metaphrasis::convertBufferToRGB565},
+		{"rgb5a3", Texel::rgb5a3, 4, 4, 16, Metaphrasis::convertBufferToRGB5A3},
+		{"rgba8", Texel::rgba8, 4, 4, 32, Metaphrasis::convertBufferToRGBA8}
+	};
+
+	uint32_t convertTexel(Texel texel, uint32_t rgba) {
+		switch (texel) {
+			case Texel::i4: return (rgba & 0xff) >> 4;
+			case Texel::i8: return rgba & 0xff;
+			case Texel::ia4: return RGBA_TO_IA4(rgba);
+			case Texel::ia8: return RGBA_TO_IA8(rgba);
+			case Texel::rgb565: return RGBA_TO_RGB565(rgba);
+			case Texel::rgb5a3: return RGBA_TO_RGB5A3(rgba);
+			case Texel::rgba8: break;
+		}
+
+		return 0;
+	}
+
+	// One texel at a time, in the order GX reads them
+	std::vector<uint8_t> convertReference(const Format &format, const std::vector<uint32_t> &pixels, unsigned int width, unsigned int height) {
+		std::vector<uint8_t> result;
+
+		for (unsigned int tileY = 0; tileY < height; tileY += format.tileHeight) {
+			for (unsigned int tileX = 0; tileX < width; tileX += format.tileWidth) {
+				if (format.texel == Texel::rgba8) { // Alpha/red pairs for the whole tile, then green/blue pairs
+					for (unsigned int y = 0; y < 4; y++) {
+						for (unsigned int x = 0; x < 4; x++) {
+							uint32_t rgba = pixels[(tileY + y) * width + tileX + x];
+
+							result.push_back(rgba & 0xff);
+							result.push_back(rgba >> 24);
+						}
+					}
+					for (unsigned int y = 0; y < 4; y++) {
+						for (unsigned int x = 0; x < 4; x++) {
+							uint32_t rgba = pixels[(tileY + y) * width + tileX + x];
+
+							result.push_back((rgba >> 16) & 0xff);
+							result.push_back((rgba >> 8) & 0xff);
+						}
+					}
+
+					continue;
+				}
+
+				for (unsigned int y = 0; y < format.tileHeight; y++) {
+					for (unsigned int x = 0; x < format.tileWidth; x++) {
+						uint32_t texel = convertTexel(format.texel, pixels[(tileY + y) * width + tileX + x]);
+
+						if (format.bitsPerPixel == 4) {
+							if (x % 2 == 0) result.push_back(texel << 4);
+							else result.back() |= texel;
+						} else if (format.bitsPerPixel == 8) {
+							result.push_back(texel);
+						} else {
+							result.push_back(texel >> 8);
+							result.push_back(texel & 0xff);
+						}
+					}
+				}
+			}
+		}
+
+		return result;
+	}
+
+	std::vector<uint32_t> randomImage(unsigned int width, unsigned int height, unsigned int seed) {
+		std::mt19937 random(seed);
+		std::vector<uint32_t> pixels(width * height);
+
+		for (uint32_t &pixel : pixels) pixel = random();
+
+		return pixels;
+	}
+
+	// Per channel, rounding to nearest, reusing the last row or column of odd sizes
+	std::vector<uint32_t> downsampleReference(const std::vector<uint32_t> &pixels, unsigned int width, unsigned int height) {
+		unsigned int halfWidth = std::max(width / 2, 1u), halfHeight = std::max(height / 2, 1u);
+		std::vector<uint32_t> result(halfWidth * halfHeight);
+
+		for (unsigned int y = 0; y < halfHeight; y++) {
+			for (unsigned int x = 0; x < halfWidth; x++) {
+				unsigned int x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+				unsigned int y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+				uint32_t samples[4] = {pixels[y0 * width + x0], pixels[y0 * width + x1], pixels[y1 * width + x0], pixels[y1 * width + x1]};
+				uint32_t color = 0;
+
+				for (int shift = 0; shift < 32; shift += 8) {
+					uint32_t sum = 2;
+
+					for (uint32_t sample : samples) sum += (sample >> shift) & 0xff;
+					color |= (sum / 4) << shift;
+				}
+
+				result[y * halfWidth + x] = color;
+			}
+		}
+
+		return result;
+	}
+
+	// Downsamples tile band by tile band out of a padded band buffer, the way the streaming PNG loader builds level 1
+	std::vector<uint32_t> downsampleBands(const std::vector<uint32_t> &pixels, unsigned int width, unsigned int height, unsigned int tileWidth, unsigned int tileHeight) {
+		unsigned int tiledWidth = (width + tileWidth - 1) / tileWidth * tileWidth;
+		unsigned int tiledHeight = (height + tileHeight - 1) / tileHeight * tileHeight;
+		unsigned int halfWidth = std::max(width / 2, 1u), halfHeight = std::max(height / 2, 1u);
+		std::vector<uint32_t> band(tiledWidth * tileHeight), result(halfWidth * halfHeight, guard);
+
+		for (unsigned int y = 0; y < tiledHeight; y++) {
+			uint32_t *row = &band[(y % tileHeight) * tiledWidth];
+
+			if (y < height) {
+				std::copy(&pixels[y * width], &pixels[y * width] + width, row);
+				std::fill(row + width, row + tiledWidth, row[width - 1]);
+			} else {
+				std::copy(&band[((height - 1) % tileHeight) * tiledWidth], &band[((height - 1) % tileHeight) * tiledWidth] + tiledWidth, row);
+			}
+
+			if (y % tileHeight == tileHeight - 1) {
+				Metaphrasis::downsampleBuffer(band.data(), width, std::min(tileHeight, height), tiledWidth, &result[(y / tileHeight) * (tileHeight / 2) * halfWidth]);
+			}
+		}
+
+		return result;
+	}
+
+	// Blocks of one or two colors that RGB565 holds exactly, some with transparent pixels, so CMPR keeps them losslessly
+	std::vector<uint32_t> exactCMPRImage(unsigned int width, unsigned int height, unsigned int seed) {
+		std::mt19937 random(seed);
+		std::vector<uint32_t> pixels(width * height);
+
+		auto exactColor = [&random] {
+			uint32_t r = random() & 0x1f, g = random() & 0x3f, b = random() & 0x1f;
+
+			return (((r << 3) | (r >> 2)) << 24) | (((g << 2) | (g >> 4)) << 16) | (((b << 3) | (b >> 2)) << 8);
+		};
+
+		for (unsigned int blockY = 0; blockY < height; blockY += 4) {
+			for (unsigned int blockX = 0; blockX < width; blockX += 4) {
+				uint32_t colors[2] = {exactColor(), exactColor()};
+				unsigned int kind = random() % 4; // Solid, two colors, or either with transparent pixels
+
+				for (unsigned int y = 0; y < 4; y++) {
+					for (unsigned int x = 0; x < 4; x++) {
+						uint32_t alpha = 0x80 + random() % 0x80; // Opaque to CMPR
+
+						if (kind >= 2 && random() % 3 == 0) alpha = random() % 0x80;
+
+						pixels[(blockY + y) * width + blockX + x] = colors[kind % 2 == 1 ? random() % 2 : 0] | alpha;
+					}
+				}
+			}
+		}
+
+		return pixels;
+	}
+
+	// Each 4x4 block encoded on its own, placed where GX reads it: 8x8 tiles of four sub-blocks in reading order
+	std::vector<uint8_t> convertCMPRReference(std::vector<uint32_t> &pixels, unsigned int width, unsigned int height) {
+		std::vector<uint8_t> result(width * height / 2);
+
+		for (unsigned int blockY = 0; blockY < height; blockY += 4) {
+			for (unsigned int blockX = 0; blockX < width; blockX += 4) {
+				unsigned int tile = (blockY / 8) * (width / 8) + blockX / 8;
+				unsigned int subBlock = (blockY % 8 / 4) * 2 + blockX % 8 / 4;
+
+				Metaphrasis::convertRGBABlockToCMPR(&pixels[blockY * width + blockX], width, &result[(tile * 4 + subBlock) * 8]);
+			}
+		}
+
+		return result;
+	}
+
+	// Opaque pixels come back with full alpha, transparent ones as transparent black
+	bool decodesExactly(const std::vector<uint32_t> &pixels, const uint32_t *decoded) {
+		for (size_t i = 0; i < pixels.size(); i++) {
+			uint32_t expected = (pixels[i] & 0xff) < 0x80 ? 0 : pixels[i] | 0xff;
+
+			if (decoded[i] != expected) return false;
+		}
+
+		return true;
+	}
+
+	bool check(const char *name, unsigned int width, unsigned int height, bool passed) {
+		std::printf("%s: %s %ux%u\n", passed ? "ok" : "FAILED", name, width, height);
+
+		return passed;
+	}
+}
+
+int main() {
+	const unsigned int sizes[] = {64, 256, 1024};
+	bool passed = true;
+
+	for (unsigned int size : sizes) {
+		std::vector<uint32_t> pixels = randomImage(size, size, size);
+
+		for (const Format &format : formats) {
+			std::vector<uint8_t> expected = convertReference(format, pixels, size, size);
+			std::vector<uint32_t> converted(expected.size() / 4 + 1, guard);
+
+			format.convert(pixels.data(), size, size, converted.data());
+
+			const uint8_t *bytes = reinterpret_cast<const uint8_t *>(converted.data());
+
+			passed &= check(format.name, size, size, std::equal(expected.begin(), expected.end(), bytes) && converted.back() == guard);
+		}
+
+		{ // CMPR is lossy, so its round trip uses blocks it can hold exactly
+			std::vector<uint32_t> exact = exactCMPRImage(size, size, size);
+			std::vector<uint8_t> expected = convertCMPRReference(exact, size, size);
+			std::vector<uint32_t> converted(expected.size() / 4 + 1, guard);
+
+			Metaphrasis::convertBufferToCMPR(exact.data(), size, size, converted.data());
+
+			const uint8_t *bytes = reinterpret_cast<const uint8_t *>(converted.data());
+			uint32_t *decoded = Metaphrasis::convertCMPRToBuffer(bytes, size, size);
+
+			passed &= check("cmpr", size, size, std::equal(expected.begin(), expected.end(), bytes) && converted.back() == guard);
+			passed &= check("cmpr round trip", size, size, decodesExactly(exact, decoded));
+
+			std::free(decoded);
+		}
+	}
+
+	// Any size, odd ones included
+	const unsigned int downsampleSizes[][2] = {{64, 64}, {7, 5}, {1, 9}, {9, 1}, {1, 1}, {256, 2}};
+
+	for (const auto &size : downsampleSizes) {
+		std::vector<uint32_t> pixels = randomImage(size[0], size[1], size[0] * 31 + size[1]);
+		std::vector<uint32_t> halved(std::max(size[0] / 2, 1u) * std::max(size[1] / 2, 1u));
+
+		Metaphrasis::downsampleBuffer(pixels.data(), size[0], size[1], size[0], halved.data());
+
+		passed &= check("downsample", size[0], size[1], halved == downsampleReference(pixels, size[0], size[1]));
+	}
+
+	// Power-of-two sizes only, like mipmapped textures, including ones smaller than a tile
+	const unsigned int bandSizes[][4] = {{16, 2, 8, 4}, {64, 32, 8, 8}, {4, 1, 8, 4}, {2, 8, 8, 8}, {1, 16, 4, 4}, {128, 64, 4, 4}};
+
+	for (const auto &size : bandSizes) {
+		std::vector<uint32_t> pixels = randomImage(size[0], size[1], size[0] * 31 + size[1]);
+
+		passed &= check(size[3] == 8 ? "downsample in 8-row bands" : "downsample in 4-row bands", size[0], size[1], downsampleBands(pixels, size[0], size[1], size[2], size[3]) == downsampleReference(pixels, size[0], size[1]));
+	}
+
+	// Host timings only show relative costs, GCC vectorizes differently for x86 than for Broadway. Smaller sizes run
+	// more often, so every size converts the same number of pixels.
+	constexpr unsigned int timedPixels = 20 * 1024 * 1024;
+
+	for (unsigned int size : sizes) {
+		unsigned int runs = timedPixels / (size * size);
+		std::vector<uint32_t> pixels = randomImage(size, size, 1);
+		std::vector<uint32_t> converted(size * size);
+
+		auto time = [&](const char *name, auto convert) {
+			auto start = std::chrono::steady_clock::now();
+
+			for (unsigned int run = 0; run < runs; run++) convert();
+
+			auto end = std::chrono::steady_clock::now();
+
+			std::printf("%-11s %ux%u: %.3f ms\n", name, size, size, std::chrono::duration<double, std::milli>(end - start).count() / runs);
+		};
+
+		for (const Format &format : formats) {
+			time(format.name, [&] { format.convert(pixels.data(), size, size, converted.data()); });
+		}
+
+		time("cmpr", [&] { Metaphrasis::convertBufferToCMPR(pixels.data(), size, size, converted.data()); });
+		time("cmpr decode", [&] { std::free(Metaphrasis::convertCMPRToBuffer(reinterpret_cast<const uint8_t *>(converted.data()), size, size)); });
+	}
+
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,97 @@
+/* WiiLÖVE particle benchmark
+ *
+ * This file is part of WiiLÖVE.
+ *
+ * Copyright (C) 2022  HTV04
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+// Host benchmark of ParticleSystem update and render at 2k, 10k and 50k particles. Rendering stops at the sprite batch,
+// which is replaced by a counter, so it measures the per-particle work on the CPU (interpolation, transform) only.
+// Host timings show relative costs, not the Wii's.
+//
+// Usage:
+//   particlebench  (prints the time per frame of each)
+
+// Libraries
+#include <grrlib-mod.h>
+#include <chrono>
+#include <cstdio>
+
+// Classes
+#include "classes/graphics/particlesystem.hpp"
+#include "classes/graphics/texture.hpp"
+
+namespace {
+	constexpr unsigned int frames = 200;
+
+	unsigned long long batchedQuads = 0;
+}
+
+// Stand-ins for what ParticleSystem calls
+unsigned long long gettime() { return 0x12345678; }
+
+namespace love {
+namespace graphics {
+
+void batchQuad(const Texture &, const float (&)[4][2], float, float, float, float, unsigned int) {
+	batchedQuads++;
+}
+
+Texture::Texture(GRRLIB_texture *texture) : instances(new int(1)), residency(nullptr), texture(texture), format(0), maxLOD(0), size(0) {}
+Texture::Texture(const Texture &other) : instances(other.instances), residency(nullptr), texture(other.texture), format(0), maxLOD(0), size(0) {
+	(*instances)++;
+}
+Texture::~Texture() {
+	if (--(*instances) == 0) delete instances;
+}
+
+} // graphics
+} // love
+
+int main() {
+	GRRLIB_texture image = {16, 16, {0.0f, 0.0f, 16.0f, 16.0f, 16, 16}, nullptr};
+	love::graphics::Texture texture(&image);
+	Mtx matrix = {{1.0f, 0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f, 0.0f}};
+
+	for (unsigned int particles : {2000u, 10000u, 50000u}) {
+		love::graphics::ParticleSystem particleSystem(texture, particles);
+
+		// Lifetimes outlast the benchmark, so the count stays at the buffer size
+		particleSystem.setParticleLifetime(1.0f, 2.0f);
+		particleSystem.setSpeed(50.0f, 100.0f);
+		particleSystem.setSpread(360.0f);
+		particleSystem.setLinearAcceleration(0.0f, 10.0f, 0.0f, 20.0f);
+		particleSystem.setSpin(0.0f, 90.0f);
+		particleSystem.emit(particles);
+
+		auto start = std::chrono::steady_clock::now();
+
+		for (unsigned int frame = 0; frame < frames; frame++) particleSystem.update(1.0f / 600.0f);
+
+		auto updated = std::chrono::steady_clock::now();
+
+		for (unsigned int frame = 0; frame < frames; frame++) particleSystem.render(matrix, 0xffffffff);
+
+		auto rendered = std::chrono::steady_clock::now();
+
+		std::printf("%5u particles: update %.3f ms, render %.3f ms per frame (%u alive)\n", particles,
+			std::chrono::duration<double, std::milli>(updated - start).count() / frames,
+			std::chrono::duration<double, std::milli>(rendered - updated).count() / frames, particleSystem.getCount());
+	}
+
+	return batchedQuads == frames * (2000 + 10000 + 50000) ? 0 : 1; // Every particle reached the batch
+}
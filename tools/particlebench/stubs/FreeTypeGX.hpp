@@ -0,0 +1,4 @@
+// Host stand-in, Font is only named by the graphics module header
+#pragma once
+
+class FreeTypeGX;
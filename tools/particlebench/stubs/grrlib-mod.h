@@ -0,0 +1,23 @@
+// Host stand-in for the parts of GRRLIB-mod ParticleSystem and its headers use
+#pragma once
+
+#include <ogc/gu.h>
+
+#define GRRLIB_R(c) (((c) >> 24) & 0xFF)
+#define GRRLIB_G(c) (((c) >> 16) & 0xFF)
+#define GRRLIB_B(c) (((c) >> 8) & 0xFF)
+#define GRRLIB_A(c) ((c) & 0xFF)
+#define GRRLIB_RGBA(r, g, b, a) ((((unsigned int)(r)) << 24) | (((unsigned int)(g)) << 16) | (((unsigned int)(b)) << 8) | ((unsigned int)(a)))
+
+#define GX_VTXFMT2 2
+
+typedef struct {
+	float x, y, width, height;
+	unsigned int textureWidth, textureHeight;
+} GRRLIB_texturePart;
+
+typedef struct {
+	unsigned int width, height;
+	GRRLIB_texturePart part;
+	void *data;
+} GRRLIB_texture;
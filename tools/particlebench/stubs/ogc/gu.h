@@ -0,0 +1,6 @@
+// Host stand-in for the libogc matrix type and angle conversion
+#pragma once
+
+typedef float Mtx[3][4];
+
+#define DegToRad(a) ((a) * 0.01745329252f)
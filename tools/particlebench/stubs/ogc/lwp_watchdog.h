@@ -0,0 +1,4 @@
+// Host stand-in for the libogc time base, ParticleSystem seeds its random state from it
+#pragma once
+
+unsigned long long gettime();
@@ -0,0 +1,311 @@
+/* WiiLÖVE texture converter
+ *
+ * This file is part of WiiLÖVE.
+ *
+ * Copyright (C) 2022  HTV04
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+// Host tool that converts PNG images into TPL files with pre-tiled GX texture data, so WiiLÖVE can load them
+// with a single read and without decoding anything.
+//
+// Usage:
+//   texconv encode <input.png> <output.tpl> [format] [mipmaps]
+//     format is one of rgba8, rgb5a3, rgb565, ia8, ia4, i8, i4 and cmpr (the default), mipmaps adds a full mip
+//     chain (power-of-two images only)
+//   texconv verify <input.png> <input.tpl>  (decodes a CMPR TPL back and prints its PSNR against the PNG)
+
+// Libraries
+#include <png.h>
+#include <Metaphrasis.hpp>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+namespace {
+	constexpr uint32_t tplMagic = 0x0020AF30;
+	constexpr uint32_t tplImageTableOffset = 0x0C;
+	constexpr uint32_t tplImageHeaderOffset = 0x14;
+	constexpr uint32_t tplDataOffset = 0x40; // Texture data is 32-byte aligned
+
+	struct Format {
+		uint32_t format; // GX_TF_*
+		unsigned int tileWidth, tileHeight;
+		unsigned int bitsPerPixel;
+		uint32_t *(*convert)(uint32_t *, uint16_t, uint16_t);
+	};
+
+	const std::map<std::string, Format> formats = {
+		{"i4", {0x0, 8, 8, 4, Metaphrasis::convertBufferToI4}},
+		{"i8", {0x1, 8, 4, 8, Metaphrasis::convertBufferToI8}},
+		{"ia4", {0x2, 8, 4, 8, Metaphrasis::convertBufferToIA4}},
+		{"ia8", {0x3, 4, 4, 16, Metaphrasis::convertBufferToIA8}},
+		{"rgb565", {0x4, 4, 4, 16, Metaphrasis::convertBufferToRGB565}},
+		{"rgb5a3", {0x5, 4, 4, 16, Metaphrasis::convertBufferToRGB5A3}},
+		{"rgba8", {0x6, 4, 4, 32, Metaphrasis::convertBufferToRGBA8}},
+		{"cmpr", {0xE, 8, 8, 4, Metaphrasis::convertBufferToCMPR}}
+	};
+
+	struct Image {
+		unsigned int width, height;
+		std::vector<uint32_t> pixels; // 0xRRGGBBAA
+	};
+
+	Image loadPNG(const char *filename) {
+		png_image png;
+		Image image;
+
+		std::memset(&png, 0, sizeof(png));
+		png.version = PNG_IMAGE_VERSION;
+
+		if (!png_image_begin_read_from_file(&png, filename)) {
+			throw std::runtime_error(std::string("Could not read PNG: ") + filename);
+		}
+
+		png.format = PNG_FORMAT_RGBA;
+
+		std::vector<unsigned char> bytes(PNG_IMAGE_SIZE(png));
+
+		if (!png_image_finish_read(&png, nullptr, bytes.data(), 0, nullptr)) {
+			throw std::runtime_error(std::string("Could not decode PNG: ") + filename);
+		}
+
+		image.width = png.width;
+		image.height = png.height;
+		image.pixels.resize(image.width * image.height);
+
+		for (unsigned int i = 0; i < image.width * image.height; i++) {
+			const unsigned char *pixel = &bytes[i * 4];
+
+			image.pixels[i] = (pixel[0] << 24) | (pixel[1] << 16) | (pixel[2] << 8) | pixel[3];
+		}
+
+		return image;
+	}
+
+	// Pads an image to whole tiles by repeating its edges
+	std::vector<uint32_t> padImage(const Image &image, unsigned int tiledWidth, unsigned int tiledHeight) {
+		std::vector<uint32_t> pixels(tiledWidth * tiledHeight);
+
+		for (unsigned int y = 0; y < tiledHeight; y++) {
+			for (unsigned int x = 0; x < tiledWidth; x++) {
+				pixels[y * tiledWidth + x] = image.pixels[std::min(y, image.height - 1) * image.width + std::min(x, image.width - 1)];
+			}
+		}
+
+		return pixels;
+	}
+
+	// Halves an image with a 2x2 box filter, using the same kernel as the runtime
+	Image downsample(const Image &image) {
+		Image half;
+
+		half.width = std::max(image.width / 2, 1u);
+		half.height = std::max(image.height / 2, 1u);
+		half.pixels.resize(half.width * half.height);
+
+		Metaphrasis::downsampleBuffer(image.pixels.data(), image.width, image.height, image.width, half.pixels.data());
+
+		return half;
+	}
+
+	// Converts one mip level, returns its tiled data
+	std::vector<unsigned char> convertLevel(const Image &image, const Format &format) {
+		unsigned int tiledWidth = (image.width + format.tileWidth - 1) / format.tileWidth * format.tileWidth;
+		unsigned int tiledHeight = (image.height + format.tileHeight - 1) / format.tileHeight * format.tileHeight;
+		std::vector<uint32_t> pixels = padImage(image, tiledWidth, tiledHeight);
+
+		// Intensity formats take their intensity from the lowest byte, use red like the runtime converter
+		if (format.format == 0x0 || format.format == 0x1) {
+			for (uint32_t &pixel : pixels) pixel = (pixel & 0xffffff00) | (pixel >> 24);
+		}
+
+		uint32_t *data = format.convert(pixels.data(), tiledWidth, tiledHeight);
+		unsigned char *bytes = reinterpret_cast<unsigned char *>(data);
+		std::vector<unsigned char> level(bytes, bytes + tiledWidth * tiledHeight * format.bitsPerPixel / 8);
+
+		std::free(data);
+
+		return level;
+	}
+
+	void writeU16(std::vector<unsigned char> &out, uint32_t offset, uint16_t value) {
+		out[offset] = value >> 8;
+		out[offset + 1] = value & 0xff;
+	}
+	void writeU32(std::vector<unsigned char> &out, uint32_t offset, uint32_t value) {
+		for (int i = 0; i < 4; i++) out[offset + i] = (value >> (24 - i * 8)) & 0xff;
+	}
+	uint16_t readU16(const std::vector<unsigned char> &in, uint32_t offset) {
+		return (in.at(offset) << 8) | in.at(offset + 1);
+	}
+	uint32_t readU32(const std::vector<unsigned char> &in, uint32_t offset) {
+		return (readU16(in, offset) << 16) | readU16(in, offset + 2);
+	}
+
+	std::vector<unsigned char> readFile(const char *filename) {
+		FILE *file = std::fopen(filename, "rb");
+
+		if (file == nullptr) throw std::runtime_error(std::string("Could not open file: ") + filename);
+
+		std::fseek(file, 0, SEEK_END);
+		std::vector<unsigned char> data(std::ftell(file));
+		std::fseek(file, 0, SEEK_SET);
+
+		size_t read = std::fread(data.data(), 1, data.size(), file);
+		std::fclose(file);
+
+		if (read != data.size()) throw std::runtime_error(std::string("Could not read file: ") + filename);
+
+		return data;
+	}
+
+	void encode(const char *input, const char *output, const std::string &formatName, bool mipmaps) {
+		if (formats.count(formatName) == 0) throw std::runtime_error("Unknown format: " + formatName);
+
+		const Format &format = formats.at(formatName);
+		Image image = loadPNG(input);
+		unsigned int width = image.width, height = image.height;
+		unsigned int levels = 1;
+
+		if (mipmaps) {
+			if ((width & (width - 1)) != 0 || (height & (height - 1)) != 0) {
+				throw std::runtime_error("Mipmapped images need power-of-two dimensions");
+			}
+
+			while ((width >> levels) > 0 || (height >> levels) > 0) levels++;
+			levels = std::min(levels, 11u); // GX supports LODs 0-10
+		}
+
+		std::vector<unsigned char> out(tplDataOffset, 0);
+
+		for (unsigned int level = 0; level < levels; level++) {
+			std::vector<unsigned char> data = convertLevel(image, format);
+
+			out.insert(out.end(), data.begin(), data.end());
+
+			if (level + 1 < levels) image = downsample(image);
+		}
+
+		writeU32(out, 0x00, tplMagic);
+		writeU32(out, 0x04, 1); // Image count
+		writeU32(out, 0x08, tplImageTableOffset);
+
+		writeU32(out, tplImageTableOffset, tplImageHeaderOffset);
+		writeU32(out, tplImageTableOffset + 4, 0); // No palette
+
+		writeU16(out, tplImageHeaderOffset + 0x00, height);
+		writeU16(out, tplImageHeaderOffset + 0x02, width);
+		writeU32(out, tplImageHeaderOffset + 0x04, format.format);
+		writeU32(out, tplImageHeaderOffset + 0x08, tplDataOffset);
+		writeU32(out, tplImageHeaderOffset + 0x14, levels > 1 ? 5 : 1); // GX_LIN_MIP_LIN or GX_LINEAR, clamped wrapping
+		writeU32(out, tplImageHeaderOffset + 0x18, 1);
+		out[tplImageHeaderOffset + 0x22] = levels - 1; // Max LOD
+
+		FILE *file = std::fopen(output, "wb");
+
+		if (file == nullptr || std::fwrite(out.data(), 1, out.size(), file) != out.size()) {
+			throw std::runtime_error(std::string("Could not write file: ") + output);
+		}
+
+		std::fclose(file);
+
+		std::printf("%s: %ux%u %s, %u level(s), %zu bytes\n", output, width, height, formatName.c_str(), levels, out.size() - tplDataOffset);
+	}
+
+	// Prints the PSNR of the decoded TPL against the PNG, returns false if it's suspiciously low
+	bool verify(const char *input, const char *tpl) {
+		Image image = loadPNG(input);
+		std::vector<unsigned char> file = readFile(tpl);
+
+		if (readU32(file, 0x00) != tplMagic) throw std::runtime_error(std::string("Not a TPL file: ") + tpl);
+
+		uint32_t imageHeader = readU32(file, readU32(file, 0x08));
+		unsigned int height = readU16(file, imageHeader), width = readU16(file, imageHeader + 2);
+		uint32_t format = readU32(file, imageHeader + 4), dataOffset = readU32(file, imageHeader + 8);
+		unsigned int tiledWidth = (width + 7) & ~7u, tiledHeight = (height + 7) & ~7u;
+
+		if (format != formats.at("cmpr").format) throw std::runtime_error("Only CMPR TPL files can be verified");
+		if (width != image.width || height != image.height) throw std::runtime_error("TPL and PNG dimensions differ");
+		if (dataOffset + tiledWidth * tiledHeight / 2 > file.size()) throw std::runtime_error("Truncated TPL file");
+
+		uint32_t *decoded = Metaphrasis::convertCMPRToBuffer(&file[dataOffset], tiledWidth, tiledHeight);
+		double squaredError = 0.0;
+		unsigned int samples = 0;
+
+		for (unsigned int y = 0; y < height; y++) {
+			for (unsigned int x = 0; x < width; x++) {
+				uint32_t a = image.pixels[y * width + x], b = decoded[y * tiledWidth + x];
+
+				if ((a & 0xff) < 0x80) { // Transparent pixels only have to stay transparent
+					squaredError += (b & 0xff) == 0 ? 0.0 : 255.0 * 255.0 * 3;
+				} else {
+					for (int shift = 8; shift < 32; shift += 8) {
+						double difference = static_cast<double>((a >> shift) & 0xff) - static_cast<double>((b >> shift) & 0xff);
+
+						squaredError += difference * difference;
+					}
+				}
+
+				samples += 3;
+			}
+		}
+
+		std::free(decoded);
+
+		double meanSquaredError = squaredError / samples;
+		double psnr = meanSquaredError == 0.0 ? INFINITY : 10.0 * std::log10(255.0 * 255.0 / meanSquaredError);
+
+		std::printf("%s: PSNR %.2f dB\n", tpl, psnr);
+
+		return psnr >= 30.0;
+	}
+}
+
+int main(int argc, char **argv) {
+	bool encoding = argc >= 4 && argc <= 6 && std::strcmp(argv[1], "encode") == 0;
+	bool verifying = argc == 4 && std::strcmp(argv[1], "verify") == 0;
+
+	if (!encoding && !verifying) {
+		std::fprintf(stderr, "Usage: %s encode <input.png> <output.tpl> [format] [mipmaps]\n       %s verify <input.png> <input.tpl>\n", argv[0], argv[0]);
+
+		return 2;
+	}
+
+	try {
+		if (encoding) {
+			bool mipmaps = (argc == 6 && std::strcmp(argv[5], "mipmaps") == 0) || (argc == 5 && std::strcmp(argv[4], "mipmaps") == 0);
+			std::string format = (argc >= 5 && std::strcmp(argv[4], "mipmaps") != 0) ? argv[4] : "cmpr";
+
+			encode(argv[2], argv[3], format, mipmaps);
+		} else if (!verify(argv[2], argv[3])) {
+			return 1;
+		}
+	} catch (const std::exception &error) {
+		std::fprintf(stderr, "%s\n", error.what());
+
+		return 1;
+	}
+
+	return 0;
+}